@@ -0,0 +1,733 @@
+//
+//  BenchmarkSuite.cpp
+//  StringSauce
+//
+//  Implementation of the benchmark matrix
+
+#include "BenchmarkSuite.hpp"
+#include "../../Source/ToneEngine.hpp"
+#include "../../Source/ModeProcessor.hpp"
+#include "../../Source/RealtimeGuard.hpp"
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Timing
+    {
+        double totalNs = 0.0;
+        double minNs   = std::numeric_limits<double>::max();
+        double maxNs   = 0.0;
+        int calls      = 0;
+
+        // realtime-guard hits in an untimed pass over the same work; -1 when the guard is off
+        juce::int64 rtAllocations = -1;
+        juce::int64 rtLocks       = -1;
+
+        void add(double ns)
+        {
+            totalNs += ns;
+            minNs = juce::jmin(minNs, ns);
+            maxNs = juce::jmax(maxNs, ns);
+            ++calls;
+        }
+    };
+
+    double nanosecondsSince(Clock::time_point start)
+    {
+        return (double) std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+    const char* modeNames[] = { "rhythm", "lead", "clean" };
+
+    using Macros = std::array<float, 6>;
+
+    // character, thump, body, shimmer, spank, space; mid-range so every stage and wet path runs
+    constexpr Macros staticMacros { 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f };
+
+    // 1 Hz sweep of every macro, offset per macro, so each block remaps
+    Macros automatedMacros(juce::int64 sample, double sampleRate)
+    {
+        const double phase = juce::MathConstants<double>::twoPi * (double) sample / sampleRate;
+
+        Macros m;
+        for (size_t i = 0; i < m.size(); ++i)
+            m[i] = 0.5f + 0.4f * (float) std::sin(phase + (double) i);
+        return m;
+    }
+
+    void updateEngine(ToneEngine& engine, const Macros& m, ToneMode mode)
+    {
+        engine.updateParameters(m[0], m[1], m[2], m[3], m[4], m[5], mode);
+    }
+
+    // a second of quarter-scale noise, looped as the input
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType> makeInput(int numChannels, double sampleRate)
+    {
+        juce::AudioBuffer<SampleType> input(numChannels, (int) sampleRate);
+        juce::Random random(0x5a5ce);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                input.setSample(ch, i, (SampleType) (0.5f * random.nextFloat() - 0.25f));
+
+        return input;
+    }
+
+    // warms up, then times blockFn over secondsPerCase of audio; blockFn(position, guarded) returns the ns it timed.
+    // with the guard compiled in, the warm-up and one more pass as long as the timed one run guarded, off the clock,
+    // and the timed blocks run unguarded, so backtraces taken for violations never land in the timings
+    template <typename BlockFn>
+    Timing timeBlocks(double sampleRate, int blockSize, const BenchmarkSuite::Config& config, BlockFn&& blockFn)
+    {
+        const int warmupBlocks = juce::jmax(1, (int) (config.warmupSeconds * sampleRate / blockSize));
+        const int timedBlocks  = juce::jmax(8, (int) (config.secondsPerCase * sampleRate / blockSize));
+
+        juce::int64 position = 0;
+        Timing timing;
+
+       #if STRINGSAUCE_RT_GUARD
+        const auto before = RealtimeGuard::getCounts();
+
+        for (int b = 0; b < warmupBlocks + timedBlocks; ++b, position += blockSize)
+            blockFn(position, true);
+
+        const auto after = RealtimeGuard::getCounts();
+        timing.rtAllocations = (juce::int64) (after.allocations - before.allocations);
+        timing.rtLocks       = (juce::int64) (after.locks - before.locks);
+       #else
+        for (int b = 0; b < warmupBlocks; ++b, position += blockSize)
+            blockFn(position, false);
+       #endif
+
+        for (int b = 0; b < timedBlocks; ++b, position += blockSize)
+            timing.add(blockFn(position, false));
+
+        return timing;
+    }
+
+    // copies the next slice of the looped input into work
+    template <typename SampleType>
+    void loadBlock(const juce::AudioBuffer<SampleType>& input, juce::AudioBuffer<SampleType>& work,
+                   juce::int64 position, int blockSize)
+    {
+        const int start = (int) (position % (juce::int64) (input.getNumSamples() - blockSize));
+
+        for (int ch = 0; ch < work.getNumChannels(); ++ch)
+        {
+            if (ch < input.getNumChannels()) work.copyFrom(ch, 0, input, ch, start, blockSize);
+            else                             work.clear(ch, 0, blockSize);
+        }
+    }
+
+    BenchmarkSuite::Result makeResult(const juce::String& id, juce::NamedValueSet fields,
+                                      const Timing& t, int blockSize, double sampleRate)
+    {
+        BenchmarkSuite::Result r;
+        r.id        = id;
+        r.fields    = std::move(fields);
+        r.nsPerCall = t.totalNs / juce::jmax(1, t.calls);
+        r.minCallNs = t.minNs;
+        r.maxCallNs = t.maxNs;
+        r.rtAllocations = t.rtAllocations;
+        r.rtLocks       = t.rtLocks;
+
+        if (blockSize > 0)
+        {
+            r.nsPerSample    = r.nsPerCall / blockSize;
+            r.realtimeFactor = ((double) blockSize / sampleRate * 1.0e9) / juce::jmax(1.0, r.nsPerCall);
+        }
+
+        return r;
+    }
+
+    juce::String rateName(double sampleRate) { return juce::String((int) sampleRate); }
+
+    // one processor on its own; apply pushes its slice of the mapped parameters
+    template <typename Processor, typename Apply>
+    Timing timeProcessor(Processor& processor, Apply&& apply, double sampleRate, int blockSize,
+                         int numChannels, bool automated, const BenchmarkSuite::Config& config)
+    {
+        processor.prepare({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+
+        ToneEngine engine;
+        engine.prepare({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+        updateEngine(engine, staticMacros, ToneMode::RHYTHM);
+        apply(processor, engine.getCurrentParameters());
+
+        const auto input = makeInput<float>(numChannels, sampleRate);
+        juce::AudioBuffer<float> work(numChannels, blockSize);
+
+        return timeBlocks(sampleRate, blockSize, config, [&](juce::int64 position, [[maybe_unused]] bool guarded)
+        {
+            loadBlock(input, work, position, blockSize);
+
+            // the mapping is outside the timer; only the processor's own update cost counts
+            if (automated)
+                updateEngine(engine, automatedMacros(position, sampleRate), ToneMode::RHYTHM);
+
+            juce::dsp::AudioBlock<float> block(work);
+            juce::dsp::ProcessContextReplacing<float> context(block);
+
+            const auto start = Clock::now();
+            {
+                STRINGSAUCE_REALTIME_SCOPE_IF(guarded);
+                if (automated) apply(processor, engine.getCurrentParameters());
+                processor.process(context);
+            }
+            return nanosecondsSince(start);
+        });
+    }
+
+    struct ChainOptions
+    {
+        int internalBlockSize = 0;
+        bool compactStorage   = false;
+        SpatialProcessor::StereoMode stereoMode = SpatialProcessor::StereoMode::LeftRight;
+    };
+
+    // the plugin's per-block work: map the macros, then run the active chain
+    template <typename SampleType>
+    Timing timeChain(ToneMode mode, double sampleRate, int blockSize, bool monoInput, bool automated,
+                     const ChainOptions& options, const BenchmarkSuite::Config& config)
+    {
+        const juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) blockSize, 2 };
+
+        ToneEngine engine;
+        engine.prepare(spec);
+
+        BasicModeProcessor<SampleType> chain;
+        chain.setInternalBlockSize(options.internalBlockSize);
+        chain.setCompactSpatialStorage(options.compactStorage);
+        chain.setSpatialStereoMode(options.stereoMode);
+        chain.setMonoInput(monoInput);
+        chain.prepare(spec);
+        chain.setMode(mode);
+
+        const auto input = makeInput<SampleType>(monoInput ? 1 : 2, sampleRate);
+        juce::AudioBuffer<SampleType> work(2, blockSize);
+
+        return timeBlocks(sampleRate, blockSize, config, [&](juce::int64 position, [[maybe_unused]] bool guarded)
+        {
+            loadBlock(input, work, position, blockSize);
+
+            juce::dsp::AudioBlock<SampleType> block(work);
+            juce::dsp::ProcessContextReplacing<SampleType> context(block);
+
+            const auto start = Clock::now();
+            {
+                STRINGSAUCE_REALTIME_SCOPE_IF(guarded);
+                updateEngine(engine, automated ? automatedMacros(position, sampleRate) : staticMacros, mode);
+                chain.process(context, engine.getCurrentParameters(), engine.getParameterGeneration());
+            }
+            return nanosecondsSince(start);
+        });
+    }
+
+    // error of compact delay storage against full, over the delay tail after a burst
+    double compactTailSnrDb(double sampleRate)
+    {
+        constexpr int blockSize = 512;
+        const juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) blockSize, 2 };
+
+        ToneEngine engine;
+        engine.prepare(spec);
+        updateEngine(engine, staticMacros, ToneMode::LEAD);
+
+        auto params = engine.getCurrentParameters().spatial;
+        params.reverbMix = 0.0f;
+        params.chorusMix = 0.0f;
+        params.delayMix  = 1.0f;
+
+        SpatialProcessor full, compact;
+        compact.setCompactStorage(true);
+
+        for (auto* p : { &full, &compact })
+        {
+            p->prepare(spec);
+            p->setParameters(params);
+        }
+
+        const auto input = makeInput<float>(2, sampleRate);
+        juce::AudioBuffer<float> a(2, blockSize), b(2, blockSize);
+
+        // 50 ms of noise, then the tail
+        const int burst  = (int) (0.05 * sampleRate);
+        const int length = (int) (SpatialProcessor::estimateTailSeconds(params) * sampleRate);
+
+        double signal = 0.0, error = 0.0;
+
+        for (int pos = 0; pos < length; pos += blockSize)
+        {
+            a.clear();
+            if (pos < burst)
+                for (int ch = 0; ch < 2; ++ch)
+                    a.copyFrom(ch, 0, input, ch, pos, juce::jmin(blockSize, burst - pos));
+            b.makeCopyOf(a, true);
+
+            juce::dsp::AudioBlock<float> blockA(a), blockB(b);
+            full.process(juce::dsp::ProcessContextReplacing<float>(blockA));
+            compact.process(juce::dsp::ProcessContextReplacing<float>(blockB));
+
+            if (pos < burst) continue;
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                auto* x = a.getReadPointer(ch);
+                auto* y = b.getReadPointer(ch);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    signal += (double) x[i] * x[i];
+                    error  += (double) (x[i] - y[i]) * (x[i] - y[i]);
+                }
+            }
+        }
+
+        return 10.0 * std::log10(juce::jmax(1.0e-30, signal) / juce::jmax(1.0e-30, error));
+    }
+}
+
+//==============================================================================
+std::vector<BenchmarkSuite::Result> BenchmarkSuite::run(std::function<void(const juce::String&)> logFn)
+{
+    log = std::move(logFn);
+    results.clear();
+
+    runMapping();
+    runProcessors();
+    runChains();
+    runVariants();
+    runStartup();
+
+    return results;
+}
+
+void BenchmarkSuite::runMapping()
+{
+    // each call sees new macros, so none returns early; the static engine case measures the early return
+    std::vector<Macros> macros((size_t) config.mapperCalls);
+    for (size_t i = 0; i < macros.size(); ++i)
+        macros[i] = automatedMacros((juce::int64) i * 64, 48000.0);
+
+    auto timeCalls = [this](const juce::String& id, const juce::String& target, const juce::String& mode,
+                            const juce::String& automation, auto&& call)
+    {
+        if (! wants(id)) return;
+        log(id);
+
+        Timing timing;
+        float sink = 0.0f;
+
+        // guarded pass off the clock, as in timeBlocks
+       #if STRINGSAUCE_RT_GUARD
+        const auto before = RealtimeGuard::getCounts();
+
+        for (int i = 0; i < config.mapperCalls; ++i)
+        {
+            STRINGSAUCE_REALTIME_SCOPE;
+            sink += call(i);
+        }
+
+        const auto after = RealtimeGuard::getCounts();
+        timing.rtAllocations = (juce::int64) (after.allocations - before.allocations);
+        timing.rtLocks       = (juce::int64) (after.locks - before.locks);
+       #endif
+
+        for (int i = 0; i < config.mapperCalls; ++i)
+        {
+            const auto start = Clock::now();
+            sink += call(i);
+            timing.add(nanosecondsSince(start));
+        }
+
+        juce::NamedValueSet fields;
+        fields.set("group", "mapping");
+        fields.set("target", target);
+        fields.set("mode", mode);
+        fields.set("automation", automation);
+        fields.set("checksum", sink);
+
+        results.push_back(makeResult(id, std::move(fields), timing, 0, 0.0));
+    };
+
+    for (int m = 0; m < 3; ++m)
+    {
+        const auto mode = (ToneMode) m;
+        const juce::String name = modeNames[m];
+
+        timeCalls("mapping/mapEQ/" + name, "ParameterMapper::mapEQ", name, "automated", [&](int i)
+        {
+            const auto& x = macros[(size_t) i];
+            return ParameterMapper::mapEQ(x[0], x[1], x[2], x[3], mode).mid1Gain;
+        });
+
+        timeCalls("mapping/mapDynamics/" + name, "ParameterMapper::mapDynamics", name, "automated", [&](int i)
+        {
+            const auto& x = macros[(size_t) i];
+            return ParameterMapper::mapDynamics(x[1], x[2], x[3], x[4], mode).compRatio;
+        });
+
+        timeCalls("mapping/mapSaturation/" + name, "ParameterMapper::mapSaturation", name, "automated", [&](int i)
+        {
+            const auto& x = macros[(size_t) i];
+            return ParameterMapper::mapSaturation(x[0], x[2], x[3], mode).drive;
+        });
+
+        timeCalls("mapping/mapSpatial/" + name, "ParameterMapper::mapSpatial", name, "automated", [&](int i)
+        {
+            const auto& x = macros[(size_t) i];
+            return ParameterMapper::mapSpatial(x[2], x[3], x[5], mode).reverbMix;
+        });
+
+        for (const bool automated : { false, true })
+        {
+            ToneEngine engine;
+            engine.prepare({ 48000.0, 512, 2 });
+
+            const juce::String automation = automated ? "automated" : "static";
+
+            timeCalls("mapping/updateParameters/" + name + "/" + automation, "ToneEngine::updateParameters",
+                      name, automation, [&](int i)
+            {
+                updateEngine(engine, automated ? macros[(size_t) i] : staticMacros, mode);
+                return engine.getCurrentParameters().outputAutoGain;
+            });
+        }
+    }
+}
+
+void BenchmarkSuite::runProcessors()
+{
+    auto runOne = [this](const juce::String& name, double sampleRate, int blockSize, int numChannels,
+                         bool automated, auto makeAndTime)
+    {
+        const juce::String automation = automated ? "automated" : "static";
+        const auto id = "processor/" + name + "/" + rateName(sampleRate) + "/" + juce::String(blockSize) + "/"
+                      + (numChannels == 1 ? "mono" : "stereo") + "/" + automation;
+
+        if (! wants(id)) return;
+        log(id);
+
+        juce::NamedValueSet fields;
+        fields.set("group", "processor");
+        fields.set("target", name);
+        fields.set("sampleRate", sampleRate);
+        fields.set("blockSize", blockSize);
+        fields.set("channels", numChannels);
+        fields.set("automation", automation);
+
+        results.push_back(makeResult(id, std::move(fields), makeAndTime(), blockSize, sampleRate));
+    };
+
+    for (const auto sampleRate : config.sampleRates)
+    {
+        for (const auto blockSize : config.blockSizes)
+        {
+            for (const bool automated : { false, true })
+            {
+                // spatial always runs after widening, so it is only measured in stereo
+                for (const int numChannels : { 1, 2 })
+                {
+                    runOne("eq", sampleRate, blockSize, numChannels, automated, [&]
+                    {
+                        EQProcessor p;
+                        return timeProcessor(p, [](auto& proc, const auto& params) { proc.setParameters(params.eq); },
+                                             sampleRate, blockSize, numChannels, automated, config);
+                    });
+
+                    runOne("dynamics", sampleRate, blockSize, numChannels, automated, [&]
+                    {
+                        DynamicsProcessor p;
+                        return timeProcessor(p, [](auto& proc, const auto& params) { proc.setParameters(params.dynamics); },
+                                             sampleRate, blockSize, numChannels, automated, config);
+                    });
+
+                    runOne("saturation", sampleRate, blockSize, numChannels, automated, [&]
+                    {
+                        SaturationProcessor p;
+                        return timeProcessor(p, [](auto& proc, const auto& params) { proc.setParameters(params.saturation); },
+                                             sampleRate, blockSize, numChannels, automated, config);
+                    });
+                }
+
+                runOne("spatial", sampleRate, blockSize, 2, automated, [&]
+                {
+                    auto p = std::make_unique<SpatialProcessor>();
+                    return timeProcessor(*p, [](auto& proc, const auto& params)
+                                         {
+                                             proc.setParameters(params.spatial);
+                                             proc.setShimmerParameters({ params.effects.shimmerPitch, params.effects.shimmerMix });
+                                         },
+                                         sampleRate, blockSize, 2, automated, config);
+                });
+            }
+        }
+    }
+}
+
+void BenchmarkSuite::runChains()
+{
+    for (const auto sampleRate : config.sampleRates)
+    {
+        for (const auto blockSize : config.blockSizes)
+        {
+            for (int m = 0; m < 3; ++m)
+            {
+                for (const bool automated : { false, true })
+                {
+                    for (const bool mono : { true, false })
+                    {
+                        const juce::String automation = automated ? "automated" : "static";
+                        const auto id = "chain/" + juce::String(modeNames[m]) + "/" + rateName(sampleRate) + "/"
+                                      + juce::String(blockSize) + "/" + (mono ? "mono" : "stereo") + "/" + automation;
+
+                        if (! wants(id)) continue;
+                        log(id);
+
+                        juce::NamedValueSet fields;
+                        fields.set("group", "chain");
+                        fields.set("target", "ModeProcessor");
+                        fields.set("mode", modeNames[m]);
+                        fields.set("sampleRate", sampleRate);
+                        fields.set("blockSize", blockSize);
+                        fields.set("channels", mono ? 1 : 2);
+                        fields.set("automation", automation);
+                        fields.set("precision", "float");
+
+                        const auto timing = timeChain<float>((ToneMode) m, sampleRate, blockSize, mono, automated, {}, config);
+                        results.push_back(makeResult(id, std::move(fields), timing, blockSize, sampleRate));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void BenchmarkSuite::runVariants()
+{
+    // engine options against the default float chain, at one representative setting
+    constexpr double sampleRate = 48000.0;
+    constexpr int hostBlock     = 1024;
+
+    struct Variant
+    {
+        juce::String name;
+        bool doublePrecision = false;
+        ChainOptions options;
+    };
+
+    std::vector<Variant> variants
+    {
+        { "default",  false, {} },
+        { "double",   true,  {} },
+        { "slice32",  false, { 32,  false } },
+        { "slice64",  false, { 64,  false } },
+        { "slice128", false, { 128, false } },
+        { "compact",  false, { 0,   true } },
+        { "midside",  false, { 0,   false, SpatialProcessor::StereoMode::MidSide } }
+    };
+
+    for (int m = 0; m < 3; ++m)
+    {
+        for (const auto& v : variants)
+        {
+            const auto id = "variant/" + v.name + "/" + juce::String(modeNames[m]) + "/" + rateName(sampleRate) + "/"
+                          + juce::String(hostBlock);
+
+            if (! wants(id)) continue;
+            log(id);
+
+            juce::NamedValueSet fields;
+            fields.set("group", "variant");
+            fields.set("target", "ModeProcessor");
+            fields.set("variant", v.name);
+            fields.set("mode", modeNames[m]);
+            fields.set("sampleRate", sampleRate);
+            fields.set("blockSize", hostBlock);
+            fields.set("channels", 2);
+            fields.set("automation", "static");
+            fields.set("precision", v.doublePrecision ? "double" : "float");
+            fields.set("internalBlockSize", v.options.internalBlockSize);
+
+            const auto timing = v.doublePrecision
+                ? timeChain<double>((ToneMode) m, sampleRate, hostBlock, false, false, v.options, config)
+                : timeChain<float> ((ToneMode) m, sampleRate, hostBlock, false, false, v.options, config);
+
+            if (v.options.compactStorage && m == 0)
+                fields.set("compactTailSnrDb", compactTailSnrDb(sampleRate));
+
+            results.push_back(makeResult(id, std::move(fields), timing, hostBlock, sampleRate));
+        }
+    }
+}
+
+void BenchmarkSuite::runStartup()
+{
+    // what a host scan or project load pays per instance before audio: the whole plugin processor
+    // (parameters, preset manager, factory presets, both precisions), prepareToPlay, first processBlock
+    for (const double sampleRate : config.sampleRates)
+    {
+        for (const int blockSize : config.blockSizes)
+        {
+            const auto id = "startup/" + rateName(sampleRate) + "/" + juce::String(blockSize);
+
+            if (! wants(id)) continue;
+            log(id);
+
+            const auto input = makeInput<float>(2, sampleRate);
+            juce::AudioBuffer<float> work(2, blockSize);
+            juce::MidiBuffer midi;
+
+            Timing construct, prepare, firstBlock, total;
+
+           #if STRINGSAUCE_RT_GUARD
+            const auto before = RealtimeGuard::getCounts();
+           #endif
+
+            for (int r = 0; r < juce::jmax(1, config.startupRepeats); ++r)
+            {
+                loadBlock(input, work, 0, blockSize);
+
+                auto start     = Clock::now();
+                auto processor = std::make_unique<StringSauceAudioProcessor>();
+                const double constructNs = nanosecondsSince(start);
+
+                // what a host does before the first callback
+                start = Clock::now();
+                processor->setRateAndBufferSizeDetails(sampleRate, blockSize);
+                processor->prepareToPlay(sampleRate, blockSize);
+                const double prepareNs = nanosecondsSince(start);
+
+                // processBlock marks itself realtime; release builds carry no guard to time
+                start = Clock::now();
+                processor->processBlock(work, midi);
+                const double firstBlockNs = nanosecondsSince(start);
+
+                // tear-down is outside the clock
+                processor.reset();
+
+                construct.add(constructNs);
+                prepare.add(prepareNs);
+                firstBlock.add(firstBlockNs);
+                total.add(constructNs + prepareNs + firstBlockNs);
+            }
+
+           #if STRINGSAUCE_RT_GUARD
+            const auto after = RealtimeGuard::getCounts();
+            total.rtAllocations = (juce::int64) (after.allocations - before.allocations);
+            total.rtLocks       = (juce::int64) (after.locks - before.locks);
+           #endif
+
+            juce::NamedValueSet fields;
+            fields.set("group", "startup");
+            fields.set("target", "StringSauceAudioProcessor");
+            fields.set("mode", modeNames[0]);
+            fields.set("sampleRate", sampleRate);
+            fields.set("blockSize", blockSize);
+            fields.set("channels", 2);
+            fields.set("precision", "float");
+            fields.set("constructNs", construct.totalNs / construct.calls);
+            fields.set("prepareNs", prepare.totalNs / prepare.calls);
+            fields.set("firstBlockNs", firstBlock.totalNs / firstBlock.calls);
+
+            // per instance, so no per-sample figures
+            results.push_back(makeResult(id, std::move(fields), total, 0, 0.0));
+        }
+    }
+}
+
+//==============================================================================
+juce::var BenchmarkSuite::toJson(const std::vector<Result>& results)
+{
+    juce::Array<juce::var> cases;
+
+    for (const auto& r : results)
+    {
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("id", r.id);
+
+        for (const auto& f : r.fields)
+            obj->setProperty(f.name, f.value);
+
+        obj->setProperty("nsPerCall", r.nsPerCall);
+        obj->setProperty("minCallNs", r.minCallNs);
+        obj->setProperty("maxCallNs", r.maxCallNs);
+
+        if (r.nsPerSample > 0.0)
+        {
+            obj->setProperty("nsPerSample", r.nsPerSample);
+            obj->setProperty("realtimeFactor", r.realtimeFactor);
+        }
+
+        if (r.rtAllocations >= 0)
+        {
+            obj->setProperty("rtAllocations", r.rtAllocations);
+            obj->setProperty("rtLocks", r.rtLocks);
+        }
+
+        cases.add(juce::var(obj));
+    }
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("suite", "StringSauceBenchmarks");
+    root->setProperty("schema", 1);
+    root->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty("numCpus", juce::SystemStats::getNumCpus());
+    root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+   #if JUCE_DEBUG
+    root->setProperty("build", "debug");
+   #else
+    root->setProperty("build", "release");
+   #endif
+    root->setProperty("results", cases);
+
+    return juce::var(root);
+}
+
+juce::StringArray BenchmarkSuite::findRegressions(const std::vector<Result>& results, const juce::var& baseline,
+                                                  double thresholdPercent)
+{
+    std::map<juce::String, juce::var> before;
+
+    if (auto* cases = baseline["results"].getArray())
+        for (const auto& c : *cases)
+            before[c["id"].toString()] = c;
+
+    juce::StringArray regressions;
+
+    for (const auto& r : results)
+    {
+        const auto it = before.find(r.id);
+        if (it == before.end()) continue;
+
+        const auto& b = it->second;
+        const double baselineNs = (double) b["nsPerCall"];
+
+        if (baselineNs > 0.0)
+        {
+            const double change = (r.nsPerCall / baselineNs - 1.0) * 100.0;
+
+            if (change > thresholdPercent)
+                regressions.add(r.id + ": " + juce::String(baselineNs, 1) + " -> " + juce::String(r.nsPerCall, 1)
+                                + " ns (+" + juce::String(change, 1) + " %)");
+        }
+
+        // any new allocation or lock on the audio path is a regression, whatever it costs
+        for (auto* name : { "rtAllocations", "rtLocks" })
+        {
+            if (! b.hasProperty(name) || r.rtAllocations < 0) continue;
+
+            const auto was = (juce::int64) b[name];
+            const auto now = juce::String(name) == "rtLocks" ? r.rtLocks : r.rtAllocations;
+
+            if (now > was)
+                regressions.add(r.id + ": " + name + " " + juce::String(was) + " -> " + juce::String(now));
+        }
+    }
+
+    return regressions;
+}
@@ -0,0 +1,73 @@
+//
+//  BenchmarkSuite.hpp
+//  StringSauce
+//
+//  Timing harness for the DSP: each processor on its own,
+//  the parameter mapping, and the whole mode chain, across
+//  block sizes, sample rates, modes, automation and channels,
+//  and what an instance costs before its first block of audio.
+
+#ifndef BenchmarkSuite_hpp
+#define BenchmarkSuite_hpp
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/ToneMode.hpp"
+
+class BenchmarkSuite
+{
+public:
+    struct Config
+    {
+        std::vector<int> blockSizes     { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+        std::vector<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+
+        double secondsPerCase = 1.0;    // audio processed per timed case
+        double warmupSeconds  = 0.25;   // processed untimed first
+        int mapperCalls       = 100000;
+        int startupRepeats    = 10;     // fresh instances per startup case
+
+        juce::String filter;            // only cases whose id contains this
+    };
+
+    // one timed case; id is stable across runs so results can be diffed
+    struct Result
+    {
+        juce::String id;
+        juce::NamedValueSet fields;     // what was measured: processor, mode, rate, ...
+        double nsPerSample   = 0.0;     // 0 for per-call cases
+        double nsPerCall     = 0.0;     // per block, or per mapping call
+        double minCallNs     = 0.0;
+        double maxCallNs     = 0.0;
+        double realtimeFactor = 0.0;    // audio seconds per CPU second, single core
+        juce::int64 rtAllocations = -1; // realtime-guard hits in the timed code; -1 when the guard is off
+        juce::int64 rtLocks       = -1;
+    };
+
+    explicit BenchmarkSuite(const Config& c) : config(c) {}
+
+    // every case in the matrix; progress goes to log
+    std::vector<Result> run(std::function<void(const juce::String&)> log);
+
+    static juce::var toJson(const std::vector<Result>& results);
+
+    // ids whose nsPerCall grew by more than thresholdPercent over the baseline JSON,
+    // or that allocate or lock more often than they did
+    static juce::StringArray findRegressions(const std::vector<Result>& results, const juce::var& baseline,
+                                             double thresholdPercent);
+
+private:
+    Config config;
+    std::vector<Result> results;
+    std::function<void(const juce::String&)> log;
+
+    bool wants(const juce::String& id) const { return config.filter.isEmpty() || id.contains(config.filter); }
+
+    void runProcessors();
+    void runMapping();
+    void runChains();
+    void runVariants();
+    void runStartup();
+};
+
+#endif
@@ -0,0 +1,125 @@
+//
+//  Main.cpp
+//  StringSauce Benchmarks
+//
+//  Runs the benchmark matrix and writes the results as JSON.
+//  Pass a previous run to --compare to list regressions.
+
+#include <JuceHeader.h>
+#include "BenchmarkSuite.hpp"
+
+namespace
+{
+    void printUsage()
+    {
+        std::cerr << "usage: StringSauceBenchmarks [options]\n"
+                     "\n"
+                     "  -o, --out <file>         write JSON here instead of stdout\n"
+                     "  --filter <text>          only cases whose id contains text, e.g. chain/lead\n"
+                     "  --blocks <n,n,...>       block sizes (default 16..4096)\n"
+                     "  --rates <hz,hz,...>      sample rates (default 44100..192000)\n"
+                     "  --seconds <s>            audio per case (default 1)\n"
+                     "  --quick                  64/512/4096 at 44.1 and 96 kHz, 0.25 s per case\n"
+                     "  --compare <file>         previous JSON to compare against\n"
+                     "  --threshold <percent>    slowdown reported as a regression (default 10)\n"
+                     "\n"
+                     "exits with 2 when --compare finds regressions\n";
+    }
+
+    template <typename T>
+    std::vector<T> parseList(const juce::String& text)
+    {
+        std::vector<T> values;
+        for (const auto& token : juce::StringArray::fromTokens(text, ",", ""))
+            if (token.trim().isNotEmpty())
+                values.push_back((T) token.trim().getDoubleValue());
+        return values;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // the startup cases build the whole plugin processor, whose parameters expect a message manager;
+    // no windows are opened, so this needs no display
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("-h|--help"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    BenchmarkSuite::Config config;
+
+    if (args.containsOption("--quick"))
+    {
+        config.blockSizes     = { 64, 512, 4096 };
+        config.sampleRates    = { 44100.0, 96000.0 };
+        config.secondsPerCase = 0.25;
+        config.warmupSeconds  = 0.05;
+        config.mapperCalls    = 20000;
+        config.startupRepeats = 3;
+    }
+
+    if (args.containsOption("--blocks"))  config.blockSizes     = parseList<int>(args.getValueForOption("--blocks"));
+    if (args.containsOption("--rates"))   config.sampleRates    = parseList<double>(args.getValueForOption("--rates"));
+    if (args.containsOption("--seconds")) config.secondsPerCase = args.getValueForOption("--seconds").getDoubleValue();
+    if (args.containsOption("--filter"))  config.filter         = args.getValueForOption("--filter");
+
+    if (config.blockSizes.empty() || config.sampleRates.empty() || config.secondsPerCase <= 0.0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    BenchmarkSuite suite(config);
+    const auto results = suite.run([](const juce::String& id) { std::cerr << id << std::endl; });
+
+    const auto json = juce::JSON::toString(BenchmarkSuite::toJson(results));
+
+    if (args.containsOption("-o|--out"))
+    {
+        const auto file = args.getFileForOption("-o|--out");
+
+        if (! file.replaceWithText(json))
+        {
+            std::cerr << "error: cannot write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << json << std::endl;
+    }
+
+    if (args.containsOption("--compare"))
+    {
+        const auto baselineFile = args.getFileForOption("--compare");
+        const auto baseline     = juce::JSON::parse(baselineFile);
+
+        if (! baseline.isObject())
+        {
+            std::cerr << "error: cannot read " << baselineFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        const double threshold  = args.containsOption("--threshold")
+                                ? args.getValueForOption("--threshold").getDoubleValue()
+                                : 10.0;
+
+        const auto regressions = BenchmarkSuite::findRegressions(results, baseline, threshold);
+
+        std::cerr << regressions.size() << " regression(s) over " << threshold << " % against "
+                  << baselineFile.getFileName() << std::endl;
+
+        for (const auto& r : regressions)
+            std::cerr << "  " << r << std::endl;
+
+        if (! regressions.isEmpty())
+            return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,411 @@
+//
+//  GoldenRenders.cpp
+//  StringSauce
+//
+//  Implementation of the golden-render check
+
+#include "GoldenRenders.hpp"
+
+namespace
+{
+    const char* modeNames[] = { "rhythm", "lead", "clean" };
+
+    juce::String slug(const juce::String& name)
+    {
+        return name.toLowerCase().replaceCharacter(' ', '-');
+    }
+
+    juce::String decibels(double gain)
+    {
+        return juce::String(juce::Decibels::gainToDecibels(gain, -200.0), 1) + " dB";
+    }
+}
+
+const char* GoldenRenders::getSignalName(Signal s)
+{
+    switch (s)
+    {
+        case Signal::sweep:   return "sweep";
+        case Signal::pluck:   return "pluck";
+        case Signal::impulse: return "impulse";
+    }
+
+    return "";
+}
+
+juce::AudioBuffer<float> GoldenRenders::makeSignal(Signal s)
+{
+    const int sr = (int) sampleRate;
+
+    // each signal is followed by silence so the tails are part of the reference
+    juce::AudioBuffer<float> buffer;
+
+    switch (s)
+    {
+        case Signal::sweep:
+        {
+            // 4 s exponential sweep, 20 Hz to 20 kHz at -12 dBFS
+            const int length = 4 * sr;
+            const double f0 = 20.0, f1 = 20000.0, k = std::log(f1 / f0);
+            const int fade = sr / 100;
+
+            buffer.setSize(1, length + sr);
+            buffer.clear();
+
+            for (int i = 0; i < length; ++i)
+            {
+                const double t     = (double) i / sampleRate;
+                const double phase = juce::MathConstants<double>::twoPi * f0 * 4.0 / k * (std::exp(k * t / 4.0) - 1.0);
+                const float env    = juce::jmin(1.0f, (float) juce::jmin(i, length - 1 - i) / (float) fade);
+
+                buffer.setSample(0, i, 0.25f * env * (float) std::sin(phase));
+            }
+            break;
+        }
+
+        case Signal::pluck:
+        {
+            // Karplus-Strong strums of the open strings, half a second each
+            const double notes[] = { 82.41, 110.0, 146.83, 196.0, 246.94, 329.63 };
+            const int noteLength = sr / 2;
+            juce::Random random(0x9017);
+
+            buffer.setSize(1, noteLength * 6 + sr);
+            buffer.clear();
+
+            for (int n = 0; n < 6; ++n)
+            {
+                std::vector<float> line((size_t) juce::roundToInt(sampleRate / notes[n]));
+                for (auto& x : line) x = 0.5f * (2.0f * random.nextFloat() - 1.0f);
+
+                auto* out = buffer.getWritePointer(0, n * noteLength);
+
+                // each note rings into the next one's start, like a strum
+                const int ring = juce::jmin(noteLength * 2, buffer.getNumSamples() - n * noteLength);
+
+                for (int i = 0; i < ring; ++i)
+                {
+                    const size_t a = (size_t) i % line.size();
+                    const size_t b = (a + 1) % line.size();
+
+                    out[i] += line[a];
+                    line[a] = 0.498f * (line[a] + line[b]);
+                }
+            }
+            break;
+        }
+
+        case Signal::impulse:
+        {
+            // full-scale click 100 ms in, then 3 s for the tails
+            buffer.setSize(1, sr / 10 + 3 * sr);
+            buffer.clear();
+            buffer.setSample(0, sr / 10, 1.0f);
+            break;
+        }
+    }
+
+    return buffer;
+}
+
+GoldenRenders::Render GoldenRenders::render(const RenderChain::Settings& settings, const juce::AudioBuffer<float>& input,
+                                            bool compactStorage) const
+{
+    Render result;
+    const int length = input.getNumSamples();
+
+    for (int repeat = 0; repeat < juce::jmax(1, options.repeats); ++repeat)
+    {
+        // a fresh chain per repeat, so every render starts from rest
+        auto chain = std::make_unique<RenderChain>();
+        chain->setSettings(settings);
+        chain->setCompactSpatialStorage(compactStorage);
+        chain->prepare(sampleRate, blockSize, 2, true, 0);
+
+        juce::AudioBuffer<float> work(2, blockSize), output(2, length);
+        double ms = 0.0;
+
+       #if STRINGSAUCE_RT_GUARD
+        const auto before = RealtimeGuard::getCounts();
+       #endif
+
+        for (int pos = 0; pos < length; pos += blockSize)
+        {
+            const int n = juce::jmin(blockSize, length - pos);
+
+            work.clear();
+            work.copyFrom(0, 0, input, 0, pos, n);
+
+            const auto t0 = juce::Time::getMillisecondCounterHiRes();
+            {
+                STRINGSAUCE_REALTIME_SCOPE;
+                chain->process(work, n);
+            }
+            ms += juce::Time::getMillisecondCounterHiRes() - t0;
+
+            for (int ch = 0; ch < 2; ++ch)
+                output.copyFrom(ch, pos, work, ch, 0, n);
+        }
+
+       #if STRINGSAUCE_RT_GUARD
+        const auto after = RealtimeGuard::getCounts();
+        const auto hits  = (juce::int64) (after.allocations - before.allocations + after.locks - before.locks);
+
+        if (hits > juce::jmax((juce::int64) 0, result.rtViolations))
+        {
+            result.rtCallSites.clear();
+
+            for (const auto& v : RealtimeGuard::getRecentViolations((int) juce::jmin(hits, (juce::int64) 3)))
+                result.rtCallSites.add(juce::String(RealtimeGuard::getKindName(v.kind)) + " at "
+                                       + v.callSite.joinIntoString(" <- ", 0, 4));
+        }
+
+        result.rtViolations = juce::jmax(result.rtViolations, hits);
+       #endif
+
+        if (repeat == 0)
+        {
+            result.output    = std::move(output);
+            result.fastestMs = ms;
+            continue;
+        }
+
+        result.fastestMs = juce::jmin(result.fastestMs, ms);
+
+        // repeats must match bit for bit; anything else is state leaking between renders
+        for (int ch = 0; ch < 2; ++ch)
+            if (std::memcmp(output.getReadPointer(ch), result.output.getReadPointer(ch), sizeof(float) * (size_t) length) != 0)
+                result.deterministic = false;
+    }
+
+    return result;
+}
+
+bool GoldenRenders::readReference(const juce::File& file, juce::AudioBuffer<float>& dest)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor(file));
+    if (reader == nullptr) return false;
+
+    dest.setSize((int) reader->numChannels, (int) reader->lengthInSamples);
+    return reader->read(&dest, 0, dest.getNumSamples(), 0, true, true);
+}
+
+bool GoldenRenders::writeReference(const juce::File& file, const juce::AudioBuffer<float>& buffer)
+{
+    file.deleteFile();
+
+    std::unique_ptr<juce::OutputStream> stream (file.createOutputStream());
+    if (stream == nullptr) return false;
+
+    // 32-bit WAV is stored as float, so the reference is the render itself
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer (wav.createWriterFor(stream.get(), sampleRate,
+                                                                         (unsigned int) buffer.getNumChannels(), 32, {}, 0));
+    if (writer == nullptr) return false;
+    stream.release();
+
+    return writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+}
+
+int GoldenRenders::run(const std::function<void(const juce::String&)>& print)
+{
+    formats.registerBasicFormats();
+
+    if (options.update && ! options.directory.createDirectory())
+    {
+        print("error: cannot create " + options.directory.getFullPathName());
+        return 1;
+    }
+
+    const auto budgetFile = options.budgetFile != juce::File()
+                          ? options.budgetFile
+                          : options.directory.getChildFile("budgets.local.json");
+    const bool recordBudgets = options.update || options.updateBudgets;
+
+    // the references are part of the tree; without them every case would fail as
+    // "no reference", so say what is missing instead
+    if (! options.update && options.directory.getNumberOfChildFiles(juce::File::findFiles, "*.wav") == 0)
+    {
+        print("error: no reference renders in " + options.directory.getFullPathName());
+        print("check out Renderer/Golden, or record a set with: --golden "
+              + options.directory.getFullPathName() + " --update");
+        return setupError;
+    }
+
+    // budgets only mean something on the machine that recorded them, so a missing file just skips them
+    auto budgets = recordBudgets ? juce::var() : juce::JSON::parse(budgetFile);
+
+    if (! recordBudgets && ! budgetFile.existsAsFile())
+        print("note: no budgets for this machine in " + budgetFile.getFullPathName()
+              + "; checking the renders only (record them with --update-budgets)");
+
+    if (! budgets.isObject())
+        budgets = juce::var(new juce::DynamicObject());
+
+    int failed = 0, checked = 0;
+
+    for (const auto signal : { Signal::sweep, Signal::pluck, Signal::impulse })
+    {
+        const auto input = makeSignal(signal);
+
+        for (const auto& preset : FactoryPresets::presets)
+        {
+            for (int m = 0; m < 3; ++m)
+            {
+                const auto id = slug(preset.name) + "/" + modeNames[m] + "/" + getSignalName(signal);
+                if (options.filter.isNotEmpty() && ! id.contains(options.filter)) continue;
+
+                auto settings = RenderChain::fromFactoryPreset(preset);
+                settings.mode = (ToneMode) m;
+
+                const auto result = render(settings, input);
+                const auto file   = options.directory.getChildFile(id.replaceCharacter('/', '_') + ".wav");
+
+                juce::StringArray problems;
+                juce::String report;
+
+                if (! result.deterministic)
+                    problems.add("repeats differ");
+
+                if (recordBudgets)
+                {
+                    auto* entry = new juce::DynamicObject();
+                    entry->setProperty("cpuMs", result.fastestMs);
+
+                    if (result.rtViolations >= 0)
+                        entry->setProperty("rtViolations", result.rtViolations);
+
+                    budgets.getDynamicObject()->setProperty(id, juce::var(entry));
+                }
+
+                if (options.update)
+                {
+                    if (! writeReference(file, result.output))
+                        problems.add("cannot write " + file.getFileName());
+
+                    report = "written";
+                }
+                else
+                {
+                    juce::AudioBuffer<float> reference;
+
+                    if (! readReference(file, reference))
+                    {
+                        problems.add("no reference " + file.getFileName());
+                    }
+                    else if (reference.getNumChannels() != result.output.getNumChannels()
+                             || reference.getNumSamples() != result.output.getNumSamples())
+                    {
+                        problems.add("reference is " + juce::String(reference.getNumChannels()) + " ch x "
+                                     + juce::String(reference.getNumSamples()) + " samples");
+                    }
+                    else
+                    {
+                        // null test: residual against the reference
+                        float maxDiff = 0.0f;
+                        double residual = 0.0, energy = 0.0;
+                        int firstFail = -1;
+
+                        for (int ch = 0; ch < reference.getNumChannels(); ++ch)
+                        {
+                            auto* x = reference.getReadPointer(ch);
+                            auto* y = result.output.getReadPointer(ch);
+
+                            for (int i = 0; i < reference.getNumSamples(); ++i)
+                            {
+                                const float d = std::abs(x[i] - y[i]);
+                                maxDiff  = juce::jmax(maxDiff, d);
+                                residual += (double) d * d;
+                                energy   += (double) x[i] * x[i];
+
+                                if (d > options.tolerance && firstFail < 0)
+                                    firstFail = i;
+                            }
+                        }
+
+                        report = "max diff " + decibels(maxDiff) + ", null "
+                               + decibels(std::sqrt(residual / juce::jmax(1.0e-30, energy)));
+
+                        if (firstFail >= 0)
+                            problems.add("over tolerance from sample " + juce::String(firstFail)
+                                         + " (" + juce::String((double) firstFail / sampleRate, 3) + " s)");
+                    }
+
+                    // entries are { cpuMs, rtViolations }; older files hold just the CPU time
+                    const auto entry  = budgets[juce::Identifier(id)];
+                    const auto budget = entry.isObject() ? (double) entry["cpuMs"] : (double) entry;
+
+                    if (budget > 0.0)
+                    {
+                        const double limit = budget * (1.0 + options.budgetMargin / 100.0);
+                        report << ", cpu " << juce::String(result.fastestMs, 2) << " / " << juce::String(limit, 2) << " ms";
+
+                        if (options.checkBudgets && result.fastestMs > limit)
+                            problems.add("over CPU budget");
+                    }
+
+                    if (result.rtViolations >= 0)
+                    {
+                        report << ", rt " << juce::String(result.rtViolations);
+
+                        if (entry.hasProperty("rtViolations") && result.rtViolations > (juce::int64) entry["rtViolations"])
+                            problems.add("allocates or locks more than the baseline ("
+                                         + entry["rtViolations"].toString() + ")");
+                    }
+                }
+
+                ++checked;
+
+                if (! problems.isEmpty())
+                    ++failed;
+
+                print(juce::String(problems.isEmpty() ? "PASS  " : "FAIL  ") + id.paddedRight(' ', 32) + report
+                      + (problems.isEmpty() ? juce::String() : "  [" + problems.joinIntoString("; ") + "]"));
+
+                for (const auto& site : result.rtCallSites)
+                    print("      " + site);
+
+                // compact delay storage has no reference of its own; it is held to the full-storage render
+                if (signal != Signal::pluck || options.update) continue;
+
+                const auto compactId = "compact/" + id;
+                const auto compact   = render(settings, input, true);
+                double signalEnergy = 0.0, errorEnergy = 0.0;
+
+                for (int ch = 0; ch < result.output.getNumChannels(); ++ch)
+                {
+                    auto* x = result.output.getReadPointer(ch);
+                    auto* y = compact.output.getReadPointer(ch);
+
+                    for (int i = 0; i < result.output.getNumSamples(); ++i)
+                    {
+                        signalEnergy += (double) x[i] * x[i];
+                        errorEnergy  += (double) (x[i] - y[i]) * (x[i] - y[i]);
+                    }
+                }
+
+                const double snr = 10.0 * std::log10(juce::jmax(1.0e-30, signalEnergy) / juce::jmax(1.0e-30, errorEnergy));
+                const bool passed = snr >= options.compactSnrFloor && compact.deterministic;
+
+                ++checked;
+
+                if (! passed)
+                    ++failed;
+
+                print(juce::String(passed ? "PASS  " : "FAIL  ") + compactId.paddedRight(' ', 32)
+                      + "snr " + juce::String(snr, 1) + " / " + juce::String(options.compactSnrFloor, 1) + " dB"
+                      + (passed ? juce::String() : juce::String("  [")
+                                                   + (compact.deterministic ? "below the SNR floor" : "repeats differ") + "]"));
+            }
+        }
+    }
+
+    if (recordBudgets && ! budgetFile.replaceWithText(juce::JSON::toString(budgets)))
+    {
+        print("error: cannot write " + budgetFile.getFullPathName());
+        ++failed;
+    }
+
+    print(juce::String(checked - failed) + "/" + juce::String(checked) + " cases passed");
+    return failed;
+}
@@ -0,0 +1,77 @@
+//
+//  GoldenRenders.hpp
+//  StringSauce
+//
+//  Regression check for the DSP: renders fixed test signals
+//  through every factory preset in every mode and compares
+//  them with the reference renders checked in under
+//  Renderer/Golden, sample by sample. The plucked renders are
+//  repeated with compact delay storage, which has to stay
+//  above a fixed SNR against full storage. CPU-time budgets are
+//  per machine and live in a separate, untracked file; where
+//  the realtime guard is compiled in, allocations and locks
+//  inside the chain are counted too and may not grow past
+//  the recorded baseline.
+
+#ifndef GoldenRenders_hpp
+#define GoldenRenders_hpp
+#pragma once
+
+#include <JuceHeader.h>
+#include "RenderChain.hpp"
+#include "../../Source/RealtimeGuard.hpp"
+
+class GoldenRenders
+{
+public:
+    struct Options
+    {
+        juce::File directory;           // reference WAVs
+        juce::File budgetFile;          // this machine's budgets; <directory>/budgets.local.json when unset
+        bool update         = false;    // write references and budgets instead of checking
+        bool updateBudgets  = false;    // check the references, then record this machine's budgets
+        float tolerance     = 1.0e-4f;  // largest per-sample difference that still passes
+        double budgetMargin = 50.0;     // percent over the stored CPU time before a case fails
+        double compactSnrFloor = 80.0;  // dB; compact delay storage against full, below this a case fails
+        bool checkBudgets   = true;
+        int repeats         = 3;        // timed renders per case; the fastest is compared to the budget
+        juce::String filter;            // only cases whose id contains this
+    };
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize     = 512;
+
+    explicit GoldenRenders(const Options& o) : options(o) {}
+
+    // returns the number of failed cases, or setupError when there are no references
+    // to check against; one report line per case goes to print
+    static constexpr int setupError = -1;
+
+    int run(const std::function<void(const juce::String&)>& print);
+
+private:
+    enum class Signal { sweep, pluck, impulse };
+
+    struct Render
+    {
+        juce::AudioBuffer<float> output;
+        double fastestMs   = 0.0;
+        bool deterministic = true;
+        juce::int64 rtViolations = -1;  // allocations + locks in the chain, worst repeat; -1 when the guard is off
+        juce::StringArray rtCallSites;  // innermost frames of the last few, one line each
+    };
+
+    Options options;
+    juce::AudioFormatManager formats;
+
+    static const char* getSignalName(Signal s);
+    static juce::AudioBuffer<float> makeSignal(Signal s);
+
+    Render render(const RenderChain::Settings& settings, const juce::AudioBuffer<float>& input,
+                  bool compactStorage = false) const;
+
+    bool readReference(const juce::File& file, juce::AudioBuffer<float>& dest);
+    bool writeReference(const juce::File& file, const juce::AudioBuffer<float>& buffer);
+};
+
+#endif
@@ -0,0 +1,354 @@
+//
+//  Main.cpp
+//  StringSauce Renderer
+//
+//  Headless batch renderer: reads WAV/FLAC stems, runs them
+//  through the StringSauce chain and writes the results.
+//  Files are spread over worker threads, each owning one chain.
+//  --golden checks the chain against stored reference renders.
+
+#include <JuceHeader.h>
+#include "RenderChain.hpp"
+#include "GoldenRenders.hpp"
+#include "../../Source/ParameterID.hpp"
+
+namespace
+{
+    struct Options
+    {
+        juce::Array<juce::File> inputs;
+        juce::File outputDir;
+        RenderChain::Settings settings;
+
+        juce::String format;            // "wav" / "flac"; empty keeps the input's
+        int bitDepth  = 24;
+        int chunkSize = 65536;          // samples read, processed and written at a time
+        int sliceSize = 512;            // DSP block inside each chunk
+        int numJobs   = juce::SystemStats::getNumCpus();
+        bool renderTail = true;
+        double maxTailSeconds = 30.0;
+
+        bool golden = false;
+        GoldenRenders::Options goldenOptions;
+    };
+
+    struct Result
+    {
+        juce::File input;
+        bool ok = false;
+        juce::String error;
+        double audioSeconds   = 0.0;
+        double processSeconds = 0.0;    // chain only
+        double totalSeconds   = 0.0;    // including decode and encode
+    };
+
+    juce::CriticalSection printLock;
+
+    void print(const juce::String& text)
+    {
+        const juce::ScopedLock sl(printLock);
+        std::cout << text << std::endl;
+    }
+
+    void printUsage()
+    {
+        print("usage: StringSauceRenderer [options] -o <dir> <input>...\n"
+              "       StringSauceRenderer --golden <dir> [--update | --update-budgets] [golden options]\n"
+              "\n"
+              "  -o, --out <dir>        output directory (created if missing)\n"
+              "  --preset <file>        .stringsauce preset saved by the plugin\n"
+              "  --factory <name>       factory preset, e.g. \"Lead Air\"\n"
+              "  --character <0..1>     macro values, applied after --preset\n"
+              "  --thump, --body, --shimmer, --spank, --space <0..1>\n"
+              "  --mode <rhythm|lead|clean>\n"
+              "  --sync, --bpm <bpm>    tempo-synced delay times at this tempo\n"
+              "  --format <wav|flac>    output format, defaults to the input's\n"
+              "  --bits <16|24|32>      output bit depth (default 24)\n"
+              "  --chunk <samples>      I/O chunk size (default 65536)\n"
+              "  --slice <samples>      DSP block size inside a chunk, 0 for whole chunks (default 512)\n"
+              "  -j, --jobs <n>         worker threads (default: all cores)\n"
+              "  --no-tail              stop at the end of the input\n"
+              "  --max-tail <seconds>   longest tail rendered (default 30)\n"
+              "\n"
+              "golden renders (every factory preset x mode x test signal, 48 kHz / 512):\n"
+              "  --golden <dir>         reference WAVs; the checked-in set is Renderer/Golden\n"
+              "  --budgets <file>       this machine's CPU budgets (default <dir>/budgets.local.json)\n"
+              "  --update               write new references and budgets\n"
+              "  --update-budgets       check the references, then record this machine's budgets\n"
+              "  --tolerance <x>        largest per-sample difference (default 1e-4)\n"
+              "  --budget-margin <pct>  allowed CPU time over budget (default 50)\n"
+              "  --compact-snr <dB>     SNR floor of compact delay storage against full (default 80)\n"
+              "  --no-budgets           report CPU time without failing on it\n"
+              "  --filter <text>        only cases whose id contains text, e.g. lead-air/clean\n"
+              "\n"
+              "references hold across builds and CPUs within --tolerance; budgets are per machine\n"
+              "and skipped when missing. --golden exits 1 on failed cases and 2 when <dir> holds\n"
+              "no reference renders");
+    }
+
+    bool parseArguments(const juce::ArgumentList& args, Options& o, juce::String& error)
+    {
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto arg = args[i].text;
+
+            auto next = [&]() -> juce::String
+            {
+                if (i + 1 >= args.size())
+                {
+                    error = "missing value after " + arg;
+                    return {};
+                }
+                return args[++i].text;
+            };
+
+            if (arg == "-o" || arg == "--out")        o.outputDir = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            else if (arg == "--format")               o.format = next().toLowerCase();
+            else if (arg == "--bits")                 o.bitDepth = next().getIntValue();
+            else if (arg == "--chunk")                o.chunkSize = next().getIntValue();
+            else if (arg == "--slice")                o.sliceSize = next().getIntValue();
+            else if (arg == "-j" || arg == "--jobs")  o.numJobs = next().getIntValue();
+            else if (arg == "--no-tail")              o.renderTail = false;
+            else if (arg == "--max-tail")             o.maxTailSeconds = next().getDoubleValue();
+            else if (arg == "--sync")                 o.settings.sync = true;
+            else if (arg == "--bpm")                  o.settings.bpm = next().getDoubleValue();
+            else if (arg == "--golden")
+            {
+                o.golden = true;
+                o.goldenOptions.directory = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            }
+            else if (arg == "--budgets")              o.goldenOptions.budgetFile = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            else if (arg == "--update")               o.goldenOptions.update = true;
+            else if (arg == "--update-budgets")       o.goldenOptions.updateBudgets = true;
+            else if (arg == "--tolerance")            o.goldenOptions.tolerance = next().getFloatValue();
+            else if (arg == "--budget-margin")        o.goldenOptions.budgetMargin = next().getDoubleValue();
+            else if (arg == "--compact-snr")          o.goldenOptions.compactSnrFloor = next().getDoubleValue();
+            else if (arg == "--no-budgets")           o.goldenOptions.checkBudgets = false;
+            else if (arg == "--filter")               o.goldenOptions.filter = next();
+            else if (arg == "--factory")
+            {
+                const auto name = next();
+                const auto* preset = RenderChain::findFactoryPreset(name);
+                if (preset == nullptr) { error = "no factory preset named " + name; return false; }
+                o.settings = RenderChain::fromFactoryPreset(*preset);
+            }
+            else if (arg == "--preset")
+            {
+                const auto file = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+                if (! RenderChain::loadPreset(file, o.settings, error)) return false;
+            }
+            else if (arg == "--mode")
+            {
+                const auto name = next().toLowerCase();
+                const int index = juce::StringArray { "rhythm", "lead", "clean" }.indexOf(name);
+                if (index < 0) { error = "unknown mode " + name; return false; }
+                o.settings.mode = (ToneMode) index;
+            }
+            else if (arg.startsWith("--") && RenderChain::getMacroIndex(arg.substring(2)) >= 0)
+            {
+                RenderChain::setValue(o.settings, arg.substring(2), next().getFloatValue());
+            }
+            else if (arg.startsWith("-"))
+            {
+                error = "unknown option " + arg;
+                return false;
+            }
+            else
+            {
+                o.inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+            }
+
+            if (error.isNotEmpty()) return false;
+        }
+
+        if (o.golden)                             return true;
+
+        if (o.inputs.isEmpty())                   error = "no input files";
+        else if (o.outputDir == juce::File())     error = "no output directory (-o)";
+        else if (o.format.isNotEmpty() && o.format != "wav" && o.format != "flac")
+                                                  error = "unsupported format " + o.format;
+        else if (o.chunkSize <= 0 || o.sliceSize < 0 || o.numJobs <= 0)
+                                                  error = "chunk, slice and jobs must be positive";
+
+        return error.isEmpty();
+    }
+
+    // one per worker thread; pulls files off the shared queue until it is empty
+    class RenderWorker : public juce::Thread
+    {
+    public:
+        RenderWorker(const Options& o, std::vector<Result>& r, std::atomic<int>& next)
+            : juce::Thread("StringSauce Render Worker"), options(o), results(r), nextIndex(next)
+        {
+            formats.registerBasicFormats();
+            chain.setSettings(options.settings);
+        }
+
+        void run() override
+        {
+            for (int i = nextIndex++; i < (int) results.size() && ! threadShouldExit(); i = nextIndex++)
+            {
+                auto& result = results[(size_t) i];
+                result.input = options.inputs[i];
+                render(result);
+
+                if (result.ok)
+                    print(result.input.getFileName() + ": " + juce::String(result.audioSeconds, 2) + " s audio, "
+                          + juce::String(result.audioSeconds / juce::jmax(1.0e-9, result.processSeconds), 1) + "x realtime ("
+                          + juce::String(result.audioSeconds / juce::jmax(1.0e-9, result.totalSeconds), 1) + "x with I/O)");
+                else
+                    print(result.input.getFileName() + ": FAILED, " + result.error);
+            }
+        }
+
+    private:
+        const Options& options;
+        std::vector<Result>& results;
+        std::atomic<int>& nextIndex;
+
+        juce::AudioFormatManager formats;
+        RenderChain chain;
+        juce::AudioBuffer<float> buffer;
+
+        void render(Result& result)
+        {
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+
+            std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor(result.input));
+            if (reader == nullptr) { result.error = "cannot read file"; return; }
+
+            const double sampleRate = reader->sampleRate;
+            const int inChannels    = (int) juce::jmin(2u, reader->numChannels);
+            const auto inLength     = reader->lengthInSamples;
+
+            // the chain is stereo out like the plugin; a mono stem widens in the spatial stage
+            constexpr int outChannels = 2;
+
+            chain.prepare(sampleRate, options.chunkSize, outChannels, inChannels == 1, options.sliceSize);
+            buffer.setSize(outChannels, options.chunkSize, false, false, true);
+
+            const auto ext  = options.format.isNotEmpty() ? options.format : result.input.getFileExtension().substring(1).toLowerCase();
+            auto* format    = formats.findFormatForFileExtension(ext == "flac" ? "flac" : "wav");
+            const int bits  = ext == "flac" ? juce::jmin(24, options.bitDepth) : options.bitDepth;
+            const auto dest = options.outputDir.getChildFile(result.input.getFileNameWithoutExtension())
+                                               .withFileExtension(ext == "flac" ? "flac" : "wav");
+
+            if (dest == result.input) { result.error = "output would overwrite the input"; return; }
+
+            dest.deleteFile();
+            std::unique_ptr<juce::OutputStream> stream (dest.createOutputStream());
+            if (stream == nullptr) { result.error = "cannot create " + dest.getFullPathName(); return; }
+
+            std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor(stream.get(), sampleRate, (unsigned int) outChannels,
+                                                                                     bits, reader->metadataValues, 0));
+            if (writer == nullptr) { result.error = "cannot encode " + ext + " at " + juce::String(bits) + " bit"; return; }
+            stream.release();
+
+            double processMs = 0.0;
+
+            // past the end of the input the buffer stays cleared, so the same step renders the tail
+            auto renderChunk = [&](juce::int64 pos, int n)
+            {
+                buffer.clear();
+                if (pos < inLength)
+                    reader->read(&buffer, 0, n, pos, true, inChannels > 1);
+
+                const auto t0 = juce::Time::getMillisecondCounterHiRes();
+                chain.process(buffer, n);
+                processMs += juce::Time::getMillisecondCounterHiRes() - t0;
+
+                return writer->writeFromAudioSampleBuffer(buffer, 0, n);
+            };
+
+            juce::int64 pos = 0;
+
+            for (; pos < inLength; pos += options.chunkSize)
+                if (! renderChunk(pos, (int) juce::jmin((juce::int64) options.chunkSize, inLength - pos)))
+                    { result.error = "write failed"; return; }
+
+            // known once the input has mapped the parameters
+            const auto tailLength = options.renderTail
+                                  ? (juce::int64) (juce::jmin(options.maxTailSeconds, chain.getTailSeconds()) * sampleRate)
+                                  : (juce::int64) 0;
+            const auto end = inLength + tailLength;
+
+            for (pos = inLength; pos < end; pos += options.chunkSize)
+                if (! renderChunk(pos, (int) juce::jmin((juce::int64) options.chunkSize, end - pos)))
+                    { result.error = "write failed"; return; }
+
+            writer.reset();
+
+            result.ok             = true;
+            result.audioSeconds   = (double) end / sampleRate;
+            result.processSeconds = processMs * 0.001;
+            result.totalSeconds   = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+        }
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.size() == 0 || args.containsOption("-h|--help"))
+    {
+        printUsage();
+        return args.size() == 0 ? 1 : 0;
+    }
+
+    Options options;
+    juce::String error;
+
+    if (! parseArguments(args, options, error))
+    {
+        print("error: " + error);
+        printUsage();
+        return 1;
+    }
+
+    if (options.golden)
+    {
+        const int failed = GoldenRenders(options.goldenOptions).run(print);
+        return failed == GoldenRenders::setupError ? 2 : (failed == 0 ? 0 : 1);
+    }
+
+    if (! options.outputDir.createDirectory())
+    {
+        print("error: cannot create " + options.outputDir.getFullPathName());
+        return 1;
+    }
+
+    std::vector<Result> results((size_t) options.inputs.size());
+    std::atomic<int> nextIndex { 0 };
+
+    const int numWorkers = juce::jmin(options.numJobs, options.inputs.size());
+    juce::OwnedArray<RenderWorker> workers;
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.add(new RenderWorker(options, results, nextIndex))->startThread();
+
+    for (auto* w : workers)
+        w->waitForThreadToExit(-1);
+
+    const double wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+    int failed = 0;
+    double audioSeconds = 0.0, processSeconds = 0.0;
+
+    for (const auto& r : results)
+    {
+        if (! r.ok) { ++failed; continue; }
+        audioSeconds   += r.audioSeconds;
+        processSeconds += r.processSeconds;
+    }
+
+    print(juce::String((int) results.size() - failed) + "/" + juce::String((int) results.size()) + " files, "
+          + juce::String(audioSeconds, 1) + " s audio in " + juce::String(wallSeconds, 2) + " s on "
+          + juce::String(numWorkers) + " threads: "
+          + juce::String(audioSeconds / juce::jmax(1.0e-9, processSeconds), 1) + "x realtime per thread, "
+          + juce::String(audioSeconds / juce::jmax(1.0e-9, wallSeconds), 1) + "x overall");
+
+    return failed == 0 ? 0 : 1;
+}
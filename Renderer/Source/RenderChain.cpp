@@ -0,0 +1,141 @@
+//
+//  RenderChain.cpp
+//  StringSauce
+//
+//  Implementation of the offline chain
+
+#include "RenderChain.hpp"
+#include "../../Source/ParameterID.hpp"
+
+int RenderChain::getMacroIndex(const juce::String& id)
+{
+    // ToneEngine::updateParameters order
+    static constexpr const char* macroIDs[6] =
+    {
+        ParamID::CHARACTER, ParamID::THUMP, ParamID::BODY,
+        ParamID::SHIMMER,   ParamID::SPANK, ParamID::SPACE
+    };
+
+    for (int i = 0; i < 6; ++i)
+        if (id == macroIDs[i])
+            return i;
+
+    return -1;
+}
+
+bool RenderChain::setValue(Settings& s, const juce::String& id, float value)
+{
+    if (const int index = getMacroIndex(id); index >= 0)
+    {
+        s.macros[(size_t) index] = juce::jlimit(0.0f, 1.0f, value);
+        return true;
+    }
+
+    if (id == ParamID::MODE)
+    {
+        s.mode = (ToneMode) juce::jlimit(0, 2, juce::roundToInt(value));
+        return true;
+    }
+
+    if (id == ParamID::SYNC)
+    {
+        s.sync = value > 0.5f;
+        return true;
+    }
+
+    return false;
+}
+
+RenderChain::Settings RenderChain::fromFactoryPreset(const FactoryPresets::Preset& preset)
+{
+    Settings s;
+
+    for (const auto& [id, normalised] : preset.values)
+        setValue(s, id, juce::String(id) == ParamID::MODE ? normalised * 2.0f : normalised);
+
+    return s;
+}
+
+const FactoryPresets::Preset* RenderChain::findFactoryPreset(const juce::String& name)
+{
+    for (const auto& preset : FactoryPresets::presets)
+        if (name.equalsIgnoreCase(preset.name))
+            return &preset;
+
+    return nullptr;
+}
+
+bool RenderChain::loadPreset(const juce::File& file, Settings& s, juce::String& error)
+{
+    auto xml = juce::XmlDocument::parse(file);
+
+    if (xml == nullptr)
+    {
+        error = "cannot parse " + file.getFullPathName();
+        return false;
+    }
+
+    // APVTS state: <Parameters><PARAM id="..." value="..."/>...</Parameters>, unnormalised
+    int applied = 0;
+
+    for (auto* param : xml->getChildWithTagNameIterator("PARAM"))
+        if (setValue(s, param->getStringAttribute("id"), (float) param->getDoubleAttribute("value")))
+            ++applied;
+
+    if (applied == 0)
+    {
+        error = "no StringSauce parameters in " + file.getFullPathName();
+        return false;
+    }
+
+    return true;
+}
+
+void RenderChain::prepare(double newSampleRate, int maxChunkSize, int numChannels, bool monoInput, int sliceSize)
+{
+    sampleRate = newSampleRate;
+
+    juce::dsp::ProcessSpec spec {
+        sampleRate,
+        (juce::uint32) juce::jmax(1, maxChunkSize),
+        (juce::uint32) numChannels
+    };
+
+    toneEngine.prepare(spec);
+
+    modeProcessor.setInternalBlockSize(sliceSize);
+    modeProcessor.setMonoInput(monoInput);
+
+    // as in the plugin: mono sources get the mid/side spatial path
+    modeProcessor.setSpatialStereoMode(monoInput ? SpatialProcessor::StereoMode::MidSide
+                                                 : SpatialProcessor::StereoMode::LeftRight);
+    modeProcessor.prepare(spec);
+
+    reset();
+}
+
+void RenderChain::reset()
+{
+    modeProcessor.reset();
+}
+
+void RenderChain::process(juce::AudioBuffer<float>& buffer, int numSamples)
+{
+    const auto& m = settings.macros;
+
+    toneEngine.setTempoSync(settings.sync, settings.bpm);
+    toneEngine.updateParameters(m[0], m[1], m[2], m[3], m[4], m[5], settings.mode);
+
+    juce::dsp::AudioBlock<float> block(buffer);
+    auto sub = block.getSubBlock(0, (size_t) numSamples);
+    juce::dsp::ProcessContextReplacing<float> context(sub);
+
+    modeProcessor.setMode(settings.mode);
+    modeProcessor.process(context, toneEngine.getCurrentParameters(), toneEngine.getParameterGeneration());
+}
+
+double RenderChain::getTailSeconds() const
+{
+    const double latency = (double) (modeProcessor.getSpatialWetLatencySamples() + modeProcessor.getLatencySamples()) / sampleRate;
+    return SpatialProcessor::estimateTailSeconds(getParameters().spatial) + latency;
+}
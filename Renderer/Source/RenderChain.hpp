@@ -0,0 +1,70 @@
+//
+//  RenderChain.hpp
+//  StringSauce
+//
+//  The plugin's ToneEngine + ModeProcessor without the
+//  AudioProcessor around it, for offline rendering.
+//  One instance per thread; nothing in here is shared.
+
+#ifndef RenderChain_hpp
+#define RenderChain_hpp
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../Source/ToneEngine.hpp"
+#include "../../Source/ModeProcessor.hpp"
+#include "../../Source/FactoryPresets.hpp"
+
+class RenderChain
+{
+public:
+    struct Settings
+    {
+        // character, thump, body, shimmer, spank, space; defaults match the plugin layout
+        std::array<float, 6> macros { 0.0f, 0.5f, 0.5f, 0.5f, 0.5f, 0.0f };
+        ToneMode mode = ToneMode::RHYTHM;
+        bool sync     = false;
+        double bpm    = 120.0;
+    };
+
+    // index into Settings::macros for a macro ParamID, -1 for anything else
+    static int getMacroIndex(const juce::String& id);
+
+    // sets one value by its ParamID ("character", ..., "mode", "sync"); false for unknown ids
+    static bool setValue(Settings& settings, const juce::String& id, float value);
+
+    // settings of a factory preset; its values are normalised, so the mode is scaled back to an index
+    static Settings fromFactoryPreset(const FactoryPresets::Preset& preset);
+
+    // case-insensitive lookup by name; nullptr when there is none
+    static const FactoryPresets::Preset* findFactoryPreset(const juce::String& name);
+
+    // applies a .stringsauce preset (the plugin's APVTS XML) on top of settings
+    static bool loadPreset(const juce::File& file, Settings& settings, juce::String& error);
+
+    // int16 spatial delay history; takes effect at the next prepare()
+    void setCompactSpatialStorage(bool shouldBeCompact) { modeProcessor.setCompactSpatialStorage(shouldBeCompact); }
+
+    void setSettings(const Settings& newSettings) { settings = newSettings; }
+    const Settings& getSettings() const           { return settings; }
+
+    // sliceSize is the DSP block inside each chunk; 0 runs whole chunks
+    void prepare(double sampleRate, int maxChunkSize, int numChannels, bool monoInput, int sliceSize);
+    void reset();
+
+    // processes numSamples (<= maxChunkSize) of buffer in place
+    void process(juce::AudioBuffer<float>& buffer, int numSamples);
+
+    // seconds of output worth rendering after the input ends
+    double getTailSeconds() const;
+
+    const ToneEngine::EngineParameters& getParameters() const { return toneEngine.getCurrentParameters(); }
+
+private:
+    Settings settings;
+    ToneEngine toneEngine;
+    ModeProcessor modeProcessor;
+    double sampleRate = 44100.0;
+};
+
+#endif
@@ -0,0 +1,133 @@
+//
+//  AnalyzerView.hpp
+//  StringSauce
+//
+//  Overlay showing the pre/post spectrum and the
+//  current macro EQ curve. Runs the analyzer only
+//  while it is on screen.
+//
+
+#ifndef AnalyzerView_h
+#define AnalyzerView_h
+#pragma once
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+class AnalyzerView : public juce::Component, private juce::Timer
+{
+public:
+    AnalyzerView(StringSauceAudioProcessor& processorRef) : processor(processorRef)
+    {
+        setInterceptsMouseClicks(false, false);
+
+        for (int i = 0; i < SpectrumAnalyzer::numBins; ++i)
+            frequencies[(size_t) i] = (double) SpectrumAnalyzer::getBinFrequency(i);
+    }
+
+    ~AnalyzerView() override
+    {
+        processor.getAnalyzer().setEnabled(false);
+    }
+
+    void visibilityChanged() override     { updateRunning(); }
+    void parentHierarchyChanged() override { updateRunning(); }
+
+    void paint(juce::Graphics& g) override
+    {
+        g.fillAll(juce::Colours::black.withAlpha(0.85f));
+
+        auto area = getLocalBounds().toFloat().reduced(8.0f);
+
+        // grid: decades and every 24 dB
+        g.setColour(juce::Colours::white.withAlpha(0.12f));
+        for (float f : { 100.0f, 1000.0f, 10000.0f })
+            g.drawVerticalLine((int) xForFrequency(area, f), area.getY(), area.getBottom());
+        for (float db = 0.0f; db > minDb; db -= 24.0f)
+            g.drawHorizontalLine((int) yForDecibels(area, db, minDb, maxDb), area.getX(), area.getRight());
+
+        g.setColour(juce::Colours::grey);
+        g.strokePath(makeSpectrumPath(area, frame.pre), juce::PathStrokeType(1.0f));
+
+        g.setColour(juce::Colours::orange);
+        g.strokePath(makeSpectrumPath(area, frame.post), juce::PathStrokeType(1.5f));
+
+        // EQ curve on its own +-eqRangeDb scale
+        juce::Path curve;
+        for (int i = 0; i < SpectrumAnalyzer::numBins; ++i)
+        {
+            const auto db = (float) juce::Decibels::gainToDecibels(magnitudes[(size_t) i], (double) -eqRangeDb);
+            const juce::Point<float> pt { xForFrequency(area, (float) frequencies[(size_t) i]),
+                                          yForDecibels(area, db, -eqRangeDb, eqRangeDb) };
+            if (i == 0) curve.startNewSubPath(pt);
+            else        curve.lineTo(pt);
+        }
+
+        g.setColour(juce::Colours::white);
+        g.strokePath(curve, juce::PathStrokeType(2.0f));
+
+        g.setFont(12.0f);
+        g.setColour(juce::Colours::grey);
+        g.drawText("Pre", area.removeFromTop(16.0f), juce::Justification::topLeft);
+        g.setColour(juce::Colours::orange);
+        g.drawText("Post", area.removeFromTop(16.0f), juce::Justification::topLeft);
+        g.setColour(juce::Colours::white);
+        g.drawText("EQ", area.removeFromTop(16.0f), juce::Justification::topLeft);
+    }
+
+private:
+    static constexpr float minDb     = -96.0f;
+    static constexpr float maxDb     = 6.0f;
+    static constexpr float eqRangeDb = 18.0f;
+
+    StringSauceAudioProcessor& processor;
+    SpectrumAnalyzer::Frame frame;
+
+    std::array<double, SpectrumAnalyzer::numBins> frequencies {};
+    std::array<double, SpectrumAnalyzer::numBins> magnitudes {};
+
+    void updateRunning()
+    {
+        const bool showing = isShowing();
+        processor.getAnalyzer().setEnabled(showing);
+
+        if (showing) startTimerHz(SpectrumAnalyzer::frameRateHz);
+        else         stopTimer();
+    }
+
+    void timerCallback() override
+    {
+        processor.getAnalyzer().getLatestFrame(frame);
+
+        const auto& eq = processor.getTelemetry().params.eq;
+        EQProcessorBase::getMagnitudeResponse(eq, frame.sampleRate, frequencies.data(), magnitudes.data(), magnitudes.size());
+
+        repaint();
+    }
+
+    static float xForFrequency(juce::Rectangle<float> area, float f)
+    {
+        const float t = std::log(f / SpectrumAnalyzer::minFrequency)
+                      / std::log(SpectrumAnalyzer::maxFrequency / SpectrumAnalyzer::minFrequency);
+        return area.getX() + t * area.getWidth();
+    }
+
+    static float yForDecibels(juce::Rectangle<float> area, float db, float lo, float hi)
+    {
+        return juce::jmap(juce::jlimit(lo, hi, db), lo, hi, area.getBottom(), area.getY());
+    }
+
+    juce::Path makeSpectrumPath(juce::Rectangle<float> area, const std::array<float, SpectrumAnalyzer::numBins>& bins) const
+    {
+        juce::Path p;
+        for (int i = 0; i < SpectrumAnalyzer::numBins; ++i)
+        {
+            const juce::Point<float> pt { xForFrequency(area, (float) frequencies[(size_t) i]),
+                                          yForDecibels(area, bins[(size_t) i], minDb, maxDb) };
+            if (i == 0) p.startNewSubPath(pt);
+            else        p.lineTo(pt);
+        }
+        return p;
+    }
+};
+
+#endif
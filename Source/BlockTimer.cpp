@@ -0,0 +1,228 @@
+//
+//  BlockTimer.cpp
+//  StringSauce
+//
+//  Implementation of the block-time histogram
+
+#include "BlockTimer.hpp"
+
+#if STRINGSAUCE_BLOCK_TIMING
+
+namespace
+{
+    const char* macroNames[] = { "character", "thump", "body", "shimmer", "spank", "space" };
+    const char* modeNames[]  = { "rhythm", "lead", "clean" };
+
+    int getBucket(double us) noexcept
+    {
+        if (us <= 1.0) return 0;
+        return juce::jmin(BlockTimer::numBuckets - 1, (int) (std::log2(us) * BlockTimer::bucketsPerOctave));
+    }
+}
+
+BlockTimer::BlockTimer()
+    : usPerTick(1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond())
+{
+    clear();
+}
+
+void BlockTimer::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    clear();
+}
+
+void BlockTimer::clear() noexcept
+{
+    for (auto& b : buckets)
+        b.store(0, std::memory_order_relaxed);
+
+    blocks.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+    maxTicks.store(0, std::memory_order_relaxed);
+    spikesWritten.store(0, std::memory_order_release);
+    resetRequested.store(false, std::memory_order_relaxed);
+}
+
+double BlockTimer::getBucketUpperUs(int bucket) noexcept
+{
+    return std::exp2((double) (bucket + 1) / bucketsPerOctave);
+}
+
+double BlockTimer::add(juce::int64 ticks, int numSamples) noexcept
+{
+    if (resetRequested.load(std::memory_order_acquire))
+        clear();
+
+    // single writer, so plain load/store instead of read-modify-write
+    const double us     = (double) ticks * usPerTick;
+    const double budget = 1.0e6 * (double) numSamples / sampleRate;
+    auto& bucket = buckets[(size_t) getBucket(us)];
+
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    blocks.store(blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    budgetUs.store(budget, std::memory_order_relaxed);
+
+    if (ticks > maxTicks.load(std::memory_order_relaxed))
+        maxTicks.store(ticks, std::memory_order_relaxed);
+
+    if (us > budget)
+        overruns.store(overruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    return budget > 0.0 ? us / budget : 0.0;
+}
+
+void BlockTimer::addSpike(juce::int64 ticks, int numSamples, const State& state) noexcept
+{
+    const auto n = spikesWritten.load(std::memory_order_relaxed);
+    auto& slot   = spikes[(size_t) (n % spikeHistorySize)];
+
+    // sequence is odd while the slot is written
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto& s      = slot.spike;
+    s.block      = blocks.load(std::memory_order_relaxed) - 1;
+    s.wallTimeMs = juce::Time::currentTimeMillis();
+    s.blockUs    = (double) ticks * usPerTick;
+    s.budgetUs   = 1.0e6 * (double) numSamples / sampleRate;
+    s.numSamples = numSamples;
+    s.sampleRate = sampleRate;
+    s.state      = state;
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    spikesWritten.store(n + 1, std::memory_order_release);
+}
+
+BlockTimer::Summary BlockTimer::getSummary() const noexcept
+{
+    Summary summary;
+
+    std::array<juce::uint32, (size_t) numBuckets> counts;
+    juce::int64 total = 0;
+
+    for (size_t b = 0; b < counts.size(); ++b)
+    {
+        counts[b] = buckets[b].load(std::memory_order_relaxed);
+        total    += counts[b];
+    }
+
+    summary.blocks   = blocks.load(std::memory_order_relaxed);
+    summary.overruns = overruns.load(std::memory_order_relaxed);
+    summary.spikes   = spikesWritten.load(std::memory_order_acquire);
+    summary.maxUs    = (double) maxTicks.load(std::memory_order_relaxed) * usPerTick;
+    summary.budgetUs = budgetUs.load(std::memory_order_relaxed);
+
+    if (total == 0) return summary;
+
+    auto percentile = [&](double q)
+    {
+        const auto target = juce::jmax((juce::int64) 1, (juce::int64) std::ceil(q * (double) total));
+        juce::int64 seen  = 0;
+
+        for (int b = 0; b < numBuckets; ++b)
+        {
+            seen += counts[(size_t) b];
+            if (seen >= target)
+                return juce::jmin(getBucketUpperUs(b), summary.maxUs);
+        }
+
+        return summary.maxUs;
+    };
+
+    summary.p50Us  = percentile(0.5);
+    summary.p99Us  = percentile(0.99);
+    summary.p999Us = percentile(0.999);
+
+    return summary;
+}
+
+std::vector<BlockTimer::Spike> BlockTimer::getRecentSpikes(int maxNumber) const
+{
+    std::vector<Spike> result;
+
+    const auto written = spikesWritten.load(std::memory_order_acquire);
+    const auto count   = juce::jmin(written, (juce::int64) spikeHistorySize, (juce::int64) juce::jmax(0, maxNumber));
+
+    for (juce::int64 i = 0; i < count; ++i)
+    {
+        const auto& slot = spikes[(size_t) ((written - 1 - i) % spikeHistorySize)];
+
+        // copy out, and drop the slot if the audio thread was in it meanwhile
+        const auto before = slot.sequence.load(std::memory_order_acquire);
+        if ((before & 1) != 0) continue;
+
+        const auto copy = slot.spike;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) continue;
+
+        result.push_back(copy);
+    }
+
+    return result;
+}
+
+juce::var BlockTimer::toJson() const
+{
+    const auto summary = getSummary();
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    root->setProperty("sampleRate", sampleRate);
+    root->setProperty("blocks", summary.blocks);
+    root->setProperty("overruns", summary.overruns);
+    root->setProperty("spikes", summary.spikes);
+    root->setProperty("spikeThreshold", spikeThreshold.load());
+    root->setProperty("budgetUs", summary.budgetUs);
+    root->setProperty("p50Us", summary.p50Us);
+    root->setProperty("p99Us", summary.p99Us);
+    root->setProperty("p999Us", summary.p999Us);
+    root->setProperty("maxUs", summary.maxUs);
+
+    juce::Array<juce::var> histogram;
+
+    for (int b = 0; b < numBuckets; ++b)
+    {
+        const auto count = buckets[(size_t) b].load(std::memory_order_relaxed);
+        if (count == 0) continue;
+
+        auto* bucket = new juce::DynamicObject();
+        bucket->setProperty("fromUs", b == 0 ? 0.0 : getBucketUpperUs(b - 1));
+        bucket->setProperty("toUs", getBucketUpperUs(b));
+        bucket->setProperty("count", (juce::int64) count);
+        histogram.add(juce::var(bucket));
+    }
+
+    root->setProperty("histogram", histogram);
+
+    juce::Array<juce::var> spikeList;
+
+    for (const auto& s : getRecentSpikes())
+    {
+        auto* spike = new juce::DynamicObject();
+        spike->setProperty("block", s.block);
+        spike->setProperty("time", juce::Time(s.wallTimeMs).toISO8601(true));
+        spike->setProperty("blockUs", s.blockUs);
+        spike->setProperty("budgetUs", s.budgetUs);
+        spike->setProperty("numSamples", s.numSamples);
+        spike->setProperty("sampleRate", s.sampleRate);
+        spike->setProperty("mode", modeNames[juce::jlimit(0, 2, s.state.mode)]);
+        spike->setProperty("sync", s.state.sync);
+        spike->setProperty("bypassed", s.state.bypassed);
+
+        auto* macros = new juce::DynamicObject();
+        for (size_t m = 0; m < s.state.macros.size(); ++m)
+            macros->setProperty(macroNames[m], s.state.macros[m]);
+
+        spike->setProperty("macros", juce::var(macros));
+        spikeList.add(juce::var(spike));
+    }
+
+    root->setProperty("recentSpikes", spikeList);
+
+    return juce::var(root);
+}
+
+#endif
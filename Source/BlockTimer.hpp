@@ -0,0 +1,128 @@
+//
+//  BlockTimer.hpp
+//  StringSauce
+//
+//  Whole-block processing times, for chasing xruns. Every block
+//  lands in a log-scaled histogram (percentiles, max), blocks
+//  over their real-time budget are counted, and blocks over
+//  the spike threshold keep a snapshot of the macros, mode and
+//  block size they ran with. Cheap enough to leave on; compiles
+//  out when STRINGSAUCE_BLOCK_TIMING is 0.
+
+#ifndef BlockTimer_hpp
+#define BlockTimer_hpp
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef STRINGSAUCE_BLOCK_TIMING
+ #define STRINGSAUCE_BLOCK_TIMING 1
+#endif
+
+#if STRINGSAUCE_BLOCK_TIMING
+
+class BlockTimer
+{
+public:
+    // what the block ran with; read only when it spiked
+    struct State
+    {
+        std::array<float, 6> macros {};   // character, thump, body, shimmer, spank, space
+        int mode      = 0;
+        bool sync     = false;
+        bool bypassed = false;
+    };
+
+    struct Spike
+    {
+        juce::int64 block      = 0;       // blocks since prepare or reset
+        juce::int64 wallTimeMs = 0;       // ms since the epoch
+        double blockUs    = 0.0;
+        double budgetUs   = 0.0;
+        int numSamples    = 0;
+        double sampleRate = 0.0;
+        State state;
+    };
+
+    struct Summary
+    {
+        juce::int64 blocks   = 0;
+        juce::int64 overruns = 0;         // blocks slower than blockSize / sampleRate
+        juce::int64 spikes   = 0;
+        double p50Us  = 0.0;              // percentiles are bucket upper edges, ~9 % resolution
+        double p99Us  = 0.0;
+        double p999Us = 0.0;
+        double maxUs  = 0.0;
+        double budgetUs = 0.0;            // of the latest block
+    };
+
+    BlockTimer();
+
+    // clears everything; call while the audio thread is idle
+    void prepare(double sampleRate);
+
+    // any thread; the audio thread clears at its next block
+    void reset() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+    // blocks above this share of their budget are captured as spikes
+    void setSpikeThreshold(double loadFraction) noexcept { spikeThreshold.store(loadFraction); }
+
+    // audio thread
+    static juce::int64 startBlock() noexcept { return juce::Time::getHighResolutionTicks(); }
+
+    template <typename GetState>
+    void endBlock(juce::int64 startTicks, int numSamples, GetState&& getState) noexcept
+    {
+        const auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+        const auto load  = add(ticks, numSamples);
+
+        if (load > spikeThreshold.load(std::memory_order_relaxed))
+            addSpike(ticks, numSamples, getState());
+    }
+
+    // any thread
+    Summary getSummary() const noexcept;
+
+    // newest first
+    std::vector<Spike> getRecentSpikes(int maxNumber = spikeHistorySize) const;
+
+    // summary, non-empty buckets and spikes, for post-mortem analysis
+    juce::var toJson() const;
+
+    static constexpr int bucketsPerOctave = 8;
+    static constexpr int numBuckets       = bucketsPerOctave * 20;   // 1 us to ~1 s
+    static constexpr int spikeHistorySize = 16;
+
+    static double getBucketUpperUs(int bucket) noexcept;
+
+private:
+    struct SpikeSlot
+    {
+        std::atomic<juce::uint32> sequence { 0 };
+        Spike spike;
+    };
+
+    std::array<std::atomic<juce::uint32>, (size_t) numBuckets> buckets;
+    std::atomic<juce::int64> blocks   { 0 };
+    std::atomic<juce::int64> overruns { 0 };
+    std::atomic<juce::int64> maxTicks { 0 };
+    std::atomic<double> budgetUs { 0.0 };
+
+    std::array<SpikeSlot, (size_t) spikeHistorySize> spikes;
+    std::atomic<juce::int64> spikesWritten { 0 };
+
+    std::atomic<bool> resetRequested { false };
+    std::atomic<double> spikeThreshold { 0.5 };
+
+    double sampleRate = 44100.0;
+    const double usPerTick;
+
+    // returns the block's share of its budget
+    double add(juce::int64 ticks, int numSamples) noexcept;
+    void addSpike(juce::int64 ticks, int numSamples, const State& state) noexcept;
+    void clear() noexcept;
+};
+
+#endif
+
+#endif
@@ -17,7 +17,13 @@ public:
     DebugContent(StringSauceAudioProcessor& processorRef) : processor(processorRef)
     {
         startTimerHz(30); 
-        setSize(330, 1600);
+        setSize(330, 2000);
+        processor.setDynamicsMeteringEnabled(true);
+    }
+
+    ~DebugContent() override
+    {
+        processor.setDynamicsMeteringEnabled(false);
     }
 
     void paint(juce::Graphics& g) override
@@ -35,7 +41,7 @@ public:
         };
 
         const auto& apvts = processor.apvts;
-        const auto& params = cachedParams;
+        const auto& params = telemetry.params;
 
         // -------------------------
         line("== Macro Parameters ==");
@@ -46,6 +52,7 @@ public:
         line("Space:     " + juce::String(*apvts.getRawParameterValue("space")));
         line("Slap:      " + juce::String(*apvts.getRawParameterValue("spank")));
         line("Mode:      " + juce::String((int)*apvts.getRawParameterValue("mode")));
+        line("Sync:      " + juce::String((int)*apvts.getRawParameterValue("sync")));
 
         // -------------------------
         line("");
@@ -103,15 +110,126 @@ public:
         line("Rate/Depth:     " + juce::String(sp.chorusRate) + " / "
                                  + juce::String(sp.chorusDepth));
         line("Stereo Width:   " + juce::String(sp.stereoWidth));
+        line("Memory (KB):    " + juce::String((double) processor.getSpatialMemoryUsageBytes() / 1024.0, 1));
+        line("Wet Rate/Lat:   " + juce::String(processor.getSpatialWetSampleRate(), 0) + " Hz / "
+                                 + juce::String(processor.getSpatialWetLatencySamples()) + " smp");
+
+        // -------------------------
+        line("");
+        line("== Shimmer ==");
+        const auto& fx = params.effects;
+        line("Pitch/Mix:      " + juce::String(fx.shimmerPitch) + " / "
+                                 + juce::String(fx.shimmerMix));
+        line("CPU Load:       " + juce::String(processor.getShimmerCpuLoad() * 100.0f, 2) + " %");
+
+        // -------------------------
+        line("");
+        line("== Engine ==");
+        line("Slept Blocks:   " + juce::String((juce::int64) processor.getSleptBlocks()));
+
+        // -------------------------
+        line("");
+        line("== Meters (dBFS) ==");
+        auto db = [](float g) { return juce::String(juce::Decibels::gainToDecibels(g), 1); };
+        line("In  Pk L/R:     " + db(telemetry.inputPeak[0])  + " / " + db(telemetry.inputPeak[1]));
+        line("In  RMS L/R:    " + db(telemetry.inputRms[0])   + " / " + db(telemetry.inputRms[1]));
+        line("Out Pk L/R:     " + db(telemetry.outputPeak[0]) + " / " + db(telemetry.outputPeak[1]));
+        line("Out RMS L/R:    " + db(telemetry.outputRms[0])  + " / " + db(telemetry.outputRms[1]));
+        line("Comp GR (dB):   " + juce::String(telemetry.dynamics.compGainReductionDb, 1));
+        line("DeEss Cut (dB): " + juce::String(telemetry.dynamics.deesserCutDb, 1));
+        line("Transient Gain: " + juce::String(telemetry.dynamics.transientGain, 2));
+
+       #if STRINGSAUCE_PROFILING
+        // -------------------------
+        line("");
+        line("== Stage CPU (us cur/avg/max, % budget) ==");
+        for (int s = 0; s < StageProfiler::numStages; ++s)
+        {
+            const auto stage = (StageProfiler::Stage) s;
+            const auto sum   = processor.getProfiler().getSummary(stage);
+            line(juce::String(StageProfiler::getStageName(stage)).paddedRight(' ', 12)
+                 + juce::String(sum.currentUs, 1) + " / "
+                 + juce::String(sum.averageUs, 1) + " / "
+                 + juce::String(sum.maxUs, 1) + "  ("
+                 + juce::String(sum.budgetPercent, 2) + " %)");
+        }
+       #endif
+
+       #if STRINGSAUCE_BLOCK_TIMING
+        // -------------------------
+        line("");
+        line("== Block Time (us) ==");
+        const auto us = [](double v) { return juce::String(v, 1); };
+        line("p50 / p99:      " + us(blockTime.p50Us) + " / " + us(blockTime.p99Us));
+        line("p99.9 / max:    " + us(blockTime.p999Us) + " / " + us(blockTime.maxUs));
+        line("Budget:         " + us(blockTime.budgetUs));
+        line("Overruns:       " + juce::String(blockTime.overruns) + " of " + juce::String(blockTime.blocks));
+        line("Spikes:         " + juce::String(blockTime.spikes));
+
+        for (const auto& s : blockSpikes)
+        {
+            juce::String macros;
+            for (auto m : s.state.macros)
+                macros << juce::String(m, 2) << " ";
+
+            line("#" + juce::String(s.block) + "  " + us(s.blockUs) + " us, " + juce::String(s.numSamples)
+                 + " smp, mode " + juce::String(s.state.mode));
+            line("  " + macros.trimEnd());
+        }
+       #endif
+
+       #if STRINGSAUCE_RT_GUARD
+        // -------------------------
+        line("");
+        line("== Realtime Safety ==");
+        line("Allocations:    " + juce::String((juce::int64) realtimeCounts.allocations));
+        line("Frees:          " + juce::String((juce::int64) realtimeCounts.deallocations));
+        line("Locks:          " + juce::String((juce::int64) realtimeCounts.locks));
+
+        for (const auto& v : realtimeViolations)
+        {
+            line(juce::String(RealtimeGuard::getKindName(v.kind))
+                 + (v.bytes > 0 ? " (" + juce::String((juce::int64) v.bytes) + " bytes)" : juce::String()));
+
+            for (int f = 0; f < juce::jmin(3, v.callSite.size()); ++f)
+                line("  " + v.callSite[f]);
+        }
+       #endif
     }
 
 private:
     StringSauceAudioProcessor& processor;
-    ToneEngine::EngineParameters cachedParams;
+    TelemetrySnapshot telemetry;
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    BlockTimer::Summary blockTime;
+    std::vector<BlockTimer::Spike> blockSpikes;
+   #endif
+
+   #if STRINGSAUCE_RT_GUARD
+    RealtimeGuard::Counts realtimeCounts;
+    std::vector<RealtimeGuard::Violation> realtimeViolations;
+   #endif
 
     void timerCallback() override
     {
-        cachedParams = processor.getEngineParams();
+        telemetry = processor.getTelemetry();
+
+       #if STRINGSAUCE_BLOCK_TIMING
+        blockTime   = processor.getBlockTimer().getSummary();
+        blockSpikes = processor.getBlockTimer().getRecentSpikes(3);
+       #endif
+
+       #if STRINGSAUCE_RT_GUARD
+        // symbolising is slow; only redo it when something new was flagged
+        const auto counts = RealtimeGuard::getCounts();
+        if (counts.total() != realtimeCounts.total())
+        {
+            realtimeCounts     = counts;
+            realtimeViolations = RealtimeGuard::getRecentViolations(4);
+        }
+       #endif
+
         repaint();
     }
 };
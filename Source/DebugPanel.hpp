@@ -12,8 +12,16 @@
 class DebugPanel : public juce::Component
 {
 public:
-    DebugPanel(StringSauceAudioProcessor& processor)
+    DebugPanel(StringSauceAudioProcessor& processorRef) : processor(processorRef)
     {
+       #if STRINGSAUCE_BLOCK_TIMING
+        addAndMakeVisible(dumpButton);
+        dumpButton.onClick = [this] { dumpBlockTimes(); };
+
+        addAndMakeVisible(resetButton);
+        resetButton.onClick = [this] { processor.getBlockTimer().reset(); };
+       #endif
+
         viewport = std::make_unique<juce::Viewport>();
         addAndMakeVisible(*viewport);
 
@@ -25,10 +33,45 @@ public:
 
     void resized() override
     {
-        viewport->setBounds(getLocalBounds());
+        auto area = getLocalBounds();
+
+       #if STRINGSAUCE_BLOCK_TIMING
+        auto bar = area.removeFromTop(32).reduced(4);
+        dumpButton.setBounds(bar.removeFromLeft(160));
+        bar.removeFromLeft(4);
+        resetButton.setBounds(bar.removeFromLeft(120));
+       #endif
+
+        viewport->setBounds(area);
     }
 
 private:
+    StringSauceAudioProcessor& processor;
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    juce::TextButton dumpButton  { "Dump Block Times..." };
+    juce::TextButton resetButton { "Reset Timing" };
+
+    // histogram and spike snapshots as JSON, for post-mortems
+    void dumpBlockTimes()
+    {
+        auto dir = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("StringSauce");
+        dir.createDirectory();
+
+        const auto name = "BlockTimes-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json";
+        auto chooser    = std::make_shared<juce::FileChooser>("Save block times...", dir.getChildFile(name), "*.json", true);
+
+        chooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles,
+                             [this, chooser](const juce::FileChooser& fc)
+                             {
+                                 const auto file = fc.getResult();
+                                 if (file == juce::File{}) return;
+
+                                 file.replaceWithText(juce::JSON::toString(processor.getBlockTimer().toJson()));
+                             });
+    }
+   #endif
+
     std::unique_ptr<juce::Viewport> viewport;
     std::unique_ptr<DebugContent> content;
 };
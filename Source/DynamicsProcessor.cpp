@@ -6,9 +6,11 @@
 
 #include "DynamicsProcessor.hpp"
 
-DynamicsProcessor::DynamicsProcessor() {}
+template <typename SampleType>
+BasicDynamicsProcessor<SampleType>::BasicDynamicsProcessor() {}
 
-void DynamicsProcessor::prepare(const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void BasicDynamicsProcessor<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate > 0.0 ? spec.sampleRate : 44100.0;
 
@@ -27,7 +29,11 @@ void DynamicsProcessor::prepare(const juce::dsp::ProcessSpec& spec)
     comp.setThreshold(-18.0f);
     comp.setRatio(2.0f);
 
-    auto neutralShelf = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, 6000.0f, 0.707f, 1.0f);
+    // detector scratch, sized once here rather than on the audio thread
+    monoScratchSize = (int) spec.maximumBlockSize;
+    monoScratch.allocate((size_t) juce::jmax(1, monoScratchSize), true);
+
+    auto neutralShelf = juce::dsp::IIR::Coefficients<SampleType>::makeHighShelf(sampleRate, 6000.0f, 0.707f, 1.0f);
     deessShelf.coefficients = neutralShelf;
 
     updateTransientEnvelopes();
@@ -36,7 +42,8 @@ void DynamicsProcessor::prepare(const juce::dsp::ProcessSpec& spec)
     isPrepared = true;
 }
 
-void DynamicsProcessor::reset()
+template <typename SampleType>
+void BasicDynamicsProcessor<SampleType>::reset()
 {
     comp.reset();
     deessHP.reset();
@@ -45,9 +52,11 @@ void DynamicsProcessor::reset()
 
     envFast = envSlow = 0.0f;
     lastDeessGainLinear = 1.0f;
+    meters = {};
 }
 
-void DynamicsProcessor::setParameters(const DynamicsParameters& p)
+template <typename SampleType>
+void BasicDynamicsProcessor<SampleType>::setParameters(const DynamicsParameters& p)
 {
     params = p;
     updateCompressor();
@@ -56,7 +65,8 @@ void DynamicsProcessor::setParameters(const DynamicsParameters& p)
     updateMakeup();
 }
 
-void DynamicsProcessor::updateCompressor()
+template <typename SampleType>
+void BasicDynamicsProcessor<SampleType>::updateCompressor()
 {
     comp.setThreshold(params.compThreshold);
     comp.setRatio(std::max(1.0f, params.compRatio));
@@ -64,7 +74,8 @@ void DynamicsProcessor::updateCompressor()
     comp.setRelease(std::max(1.0f, params.compRelease));
 }
 
-void DynamicsProcessor::updateDeesserFilters()
+template <typename SampleType>
+void BasicDynamicsProcessor<SampleType>::updateDeesserFilters()
 {
     const float center = juce::jlimit(2000.0f, 16000.0f, params.deesserFreq);
     const float bw = 1.414f;
@@ -72,19 +83,21 @@ void DynamicsProcessor::updateDeesserFilters()
     const float hpFreq = center / bw;
     const float lpFreq = center * bw;
 
-    deessHP.coefficients = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, hpFreq);
-    deessLP.coefficients = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, lpFreq);
+    deessHP.coefficients = juce::dsp::IIR::Coefficients<SampleType>::makeHighPass(sampleRate, hpFreq);
+    deessLP.coefficients = juce::dsp::IIR::Coefficients<SampleType>::makeLowPass(sampleRate, lpFreq);
 }
 
-void DynamicsProcessor::updateDeesserShelf(float linearCut)
+template <typename SampleType>
+void BasicDynamicsProcessor<SampleType>::updateDeesserShelf(float linearCut)
 {
     const float shelfFreq = juce::jlimit(2000.0f, 16000.0f, params.deesserFreq);
-    auto coeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sampleRate, shelfFreq, 0.707f, juce::jlimit(0.1f, 1.0f, linearCut));
+    auto coeffs = juce::dsp::IIR::Coefficients<SampleType>::makeHighShelf(sampleRate, shelfFreq, 0.707f, juce::jlimit(0.1f, 1.0f, linearCut));
 
     deessShelf.coefficients = coeffs;
 }
 
-void DynamicsProcessor::updateTransientEnvelopes()
+template <typename SampleType>
+void BasicDynamicsProcessor<SampleType>::updateTransientEnvelopes()
 {
     const float aFast = 0.002f, rFast = 0.020f;
     const float aSlow = 0.020f, rSlow = 0.200f;
@@ -95,12 +108,14 @@ void DynamicsProcessor::updateTransientEnvelopes()
     relCoeffSlow = std::exp(-1.0f / (rSlow * sampleRate));
 }
 
-void DynamicsProcessor::updateMakeup()
+template <typename SampleType>
+void BasicDynamicsProcessor<SampleType>::updateMakeup()
 {
     makeupLinear = dbToLin(params.compMakeupGain);
 }
 
-void DynamicsProcessor::process(const juce::dsp::ProcessContextReplacing<float>& context)
+template <typename SampleType>
+void BasicDynamicsProcessor<SampleType>::process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
 {
     if (!isPrepared)
         return;
@@ -114,7 +129,11 @@ void DynamicsProcessor::process(const juce::dsp::ProcessContextReplacing<float>&
         std::abs(p.transientAttack) < 0.001f &&
         std::abs(p.transientSustain) < 0.001f;
 
-    if (isBypassed) return;
+    if (isBypassed)
+    {
+        meters = {};
+        return;
+    }
 
 
 
@@ -122,32 +141,57 @@ void DynamicsProcessor::process(const juce::dsp::ProcessContextReplacing<float>&
     const int numCh = (int)block.getNumChannels();
     const int numSm = (int)block.getNumSamples();
 
-    if (numCh <= 0 || numSm <= 0) return;
+    if (numCh <= 0 || numSm <= 0 || numSm > monoScratchSize) return;
+
+    // block energy across every channel, to meter the compressor
+    auto energy = [&block, numCh, numSm]
+    {
+        double e = 0.0;
+        for (int ch = 0; ch < numCh; ++ch)
+        {
+            const auto* data = block.getChannelPointer((size_t) ch);
+            for (int i = 0; i < numSm; ++i)
+                e += (double) data[i] * (double) data[i];
+        }
+        return e;
+    };
 
     // Step 1) Broadband Compression
-    comp.process(context);
+    if (meteringEnabled)
+    {
+        const double energyIn = energy();
+        comp.process(context);
+        const double energyOut = energy();
+
+        meters.compGainReductionDb = energyIn > 1.0e-12
+            ? juce::jmin(0.0f, (float) (10.0 * std::log10(juce::jmax(1.0e-12, energyOut) / energyIn)))
+            : 0.0f;
+    }
+    else
+    {
+        comp.process(context);
+        meters.compGainReductionDb = 0.0f;
+    }
 
     // Step 2) De-esser
-    static thread_local juce::HeapBlock<float> tmp;
-    tmp.allocate(numSm, false);
-    float* mono = tmp.getData();
+    SampleType* mono = monoScratch.getData();
 
     for (int i = 0; i < numSm; ++i)
     {
-        float s = 0.0f;
+        SampleType s = 0;
         for (int ch = 0; ch < numCh; ++ch)
             s += block.getChannelPointer(ch)[i];
-        mono[i] = s / std::max(1, numCh);
+        mono[i] = s / (SampleType) std::max(1, numCh);
     }
 
-    float* channels[] = { mono };
-    juce::dsp::AudioBlock<float> mBlock(channels, 1, (size_t)numSm);
-    deessHP.process(juce::dsp::ProcessContextReplacing<float>(mBlock));
-    deessLP.process(juce::dsp::ProcessContextReplacing<float>(mBlock));
+    SampleType* channels[] = { mono };
+    juce::dsp::AudioBlock<SampleType> mBlock(channels, 1, (size_t)numSm);
+    deessHP.process(juce::dsp::ProcessContextReplacing<SampleType>(mBlock));
+    deessLP.process(juce::dsp::ProcessContextReplacing<SampleType>(mBlock));
 
     // Compute RMS in dB
     float accum = 0.0f;
-    for (int i = 0; i < numSm; ++i) accum += mono[i] * mono[i];
+    for (int i = 0; i < numSm; ++i) accum += (float) (mono[i] * mono[i]);
     float rms = std::sqrt(accum / std::max(1, numSm));
     float rmsDb = linToDb(std::max(1.0e-8f, rms));
 
@@ -157,16 +201,18 @@ void DynamicsProcessor::process(const juce::dsp::ProcessContextReplacing<float>&
 
     lastDeessGainLinear = lastDeessGainLinear * 0.8f + targetCutLinear * 0.2f;
     updateDeesserShelf(lastDeessGainLinear);
+    meters.deesserCutDb = linToDb(lastDeessGainLinear);
 
     deessShelf.process(context);
 
     // Step 3) Transient shaping
     if (numCh > 0)
     {
+        float gainSum = 0.0f;
         auto* ch0 = block.getChannelPointer(0);
         for (int i = 0; i < numSm; ++i)
         {
-            const float x = std::abs(ch0[i]);
+            const float x = (float) std::abs(ch0[i]);
 
             // fast and slow envelopes
             envFast = (x > envFast)
@@ -183,16 +229,22 @@ void DynamicsProcessor::process(const juce::dsp::ProcessContextReplacing<float>&
             float gSus = 1.0f + params.transientSustain * (envSlow * 0.5f);
 
             float g = juce::jlimit(0.25f, 4.0f, gAtk * gSus);
+            gainSum += g;
 
             for (int ch = 0; ch < numCh; ++ch)
-                block.getChannelPointer(ch)[i] *= g;
+                block.getChannelPointer(ch)[i] *= (SampleType) g;
         }
+
+        meters.transientGain = gainSum / (float) numSm;
     }
 
     // Step 4) Makeup gain 
     for (int ch = 0; ch < numCh; ++ch)
     {
         auto* data = block.getChannelPointer(ch);
-        juce::FloatVectorOperations::multiply(data, makeupLinear, numSm);
+        juce::FloatVectorOperations::multiply(data, (SampleType) makeupLinear, numSm);
     }
 }
+
+template class BasicDynamicsProcessor<float>;
+template class BasicDynamicsProcessor<double>;
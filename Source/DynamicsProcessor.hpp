@@ -13,7 +13,8 @@
 
 #include <JuceHeader.h>
 
-class DynamicsProcessor : public juce::dsp::ProcessorBase
+// parameters shared by every sample type
+class DynamicsProcessorBase
 {
 public:
     struct DynamicsParameters
@@ -35,19 +36,45 @@ public:
         float transientSustain  = 0.0f;    //[-1..+1] boost/cut sustain
     };
 
-    DynamicsProcessor();
+    // what the last block did, for metering
+    struct Meters
+    {
+        float compGainReductionDb = 0.0f;  // <= 0
+        float deesserCutDb        = 0.0f;  // <= 0
+        float transientGain       = 1.0f;  // block average
+    };
+
+    const Meters& getMeters() const noexcept { return meters; }
+
+    // compressor gain reduction takes two passes over the block, so it
+    // is only measured while something reads the meters; 0 otherwise
+    void setMeteringEnabled(bool shouldMeter) noexcept { meteringEnabled = shouldMeter; }
+
+protected:
+    Meters meters;
+    bool meteringEnabled = false;
+};
 
-    void prepare (const juce::dsp::ProcessSpec& spec) override;
-    void process (const juce::dsp::ProcessContextReplacing<float>& context) override;
-    void reset   () override;
+// audio path runs in SampleType; detectors and envelopes stay float
+template <typename SampleType>
+class BasicDynamicsProcessor : public DynamicsProcessorBase
+{
+public:
+    BasicDynamicsProcessor();
+
+    void prepare (const juce::dsp::ProcessSpec& spec);
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context);
+    void reset   ();
 
     void setParameters(const DynamicsParameters& p);
 
 private:
-    juce::dsp::Compressor<float> comp;
-    juce::dsp::IIR::Filter<float> deessHP;
-    juce::dsp::IIR::Filter<float> deessLP;
-    juce::dsp::IIR::Filter<float> deessShelf;
+    juce::dsp::Compressor<SampleType> comp;
+    juce::dsp::IIR::Filter<SampleType> deessHP;
+    juce::dsp::IIR::Filter<SampleType> deessLP;
+    juce::dsp::IIR::Filter<SampleType> deessShelf;
+    juce::HeapBlock<SampleType> monoScratch;
+    int monoScratchSize = 0;
     float lastDeessGainLinear = 1.0f;
     float envFast = 0.0f, envSlow = 0.0f;
     float atkCoeffFast = 0.0f, relCoeffFast = 0.0f;
@@ -69,4 +96,6 @@ private:
     
 };
 
+using DynamicsProcessor = BasicDynamicsProcessor<float>;
+
 #endif
@@ -7,91 +7,183 @@
 
 #include "EQProcessor.hpp"
 
-EQProcessor::EQProcessor() {}
-
-void EQProcessor::prepare(const juce::dsp::ProcessSpec& spec)
+template <typename StateType>
+EQProcessorBase::BandCoefficients<StateType> EQProcessorBase::designBands(const EQParameters& p, double sr)
 {
-    currentSpec = spec;
-    eqChain.prepare(spec);
-    reset();
+    using Coeffs = juce::dsp::IIR::ArrayCoefficients<StateType>;
+
+    // safety clamps
+    auto safeGain = [](float g)
+    {
+        if (std::isnan(g) || std::isinf(g) || g <= 0.0f) return (StateType) 1;
+        return (StateType) juce::jlimit(0.05f, 8.0f, g);
+    };
+    auto safeFreq = [sr](float f)
+    {
+        return (StateType) juce::jlimit(20.0f, (float)(sr * 0.45), f);
+    };
+    auto safeQ = [](float q)
+    {
+        return (StateType) juce::jlimit(0.2f, 4.0f, q);
+    };
+
+    const auto shelfQ = (StateType) 0.7;
+
+    return {{
+        Coeffs::makeHighPass  (sr, safeFreq(p.lowCutFreq)),
+        Coeffs::makeLowShelf  (sr, safeFreq(p.lowShelfFreq), shelfQ, safeGain(p.lowShelfGain)),
+        Coeffs::makePeakFilter(sr, safeFreq(p.mid1Freq), safeQ(p.mid1Q), safeGain(p.mid1Gain)),
+        Coeffs::makePeakFilter(sr, safeFreq(p.mid2Freq), safeQ(p.mid2Q), safeGain(p.mid2Gain)),
+        Coeffs::makeHighShelf (sr, safeFreq(p.highShelfFreq), shelfQ, safeGain(p.highShelfGain)),
+        Coeffs::makeHighShelf (sr, safeFreq(p.airBandFreq), shelfQ, safeGain(p.airBandGain))
+    }};
 }
 
-void EQProcessor::setParameters(const EQParameters& params)
+template EQProcessorBase::BandCoefficients<float>  EQProcessorBase::designBands<float> (const EQParameters&, double);
+template EQProcessorBase::BandCoefficients<double> EQProcessorBase::designBands<double>(const EQParameters&, double);
+
+bool EQProcessorBase::isFlat(const EQParameters& p)
 {
-    currentParams = params;
-    updateFilterCoefficients();
+    return std::abs(p.lowShelfGain - 1.0f) < 0.001f &&
+           std::abs(p.mid1Gain     - 1.0f) < 0.001f &&
+           std::abs(p.mid2Gain     - 1.0f) < 0.001f &&
+           std::abs(p.highShelfGain- 1.0f) < 0.001f &&
+           std::abs(p.airBandGain  - 1.0f) < 0.001f;
 }
 
-void EQProcessor::process(juce::dsp::ProcessContextReplacing<float>& context)
+void EQProcessorBase::getMagnitudeResponse(const EQParameters& p, double sampleRate,
+                                           const double* frequencies, double* magnitudes, size_t num)
 {
-    const auto& p = currentParams;
+    std::fill(magnitudes, magnitudes + num, 1.0);
 
-    // bypass if all filters are essentially neutral
-    const bool isFlat =
-        std::abs(p.lowShelfGain - 1.0f) < 0.001f &&
-        std::abs(p.mid1Gain     - 1.0f) < 0.001f &&
-        std::abs(p.mid2Gain     - 1.0f) < 0.001f &&
-        std::abs(p.highShelfGain- 1.0f) < 0.001f &&
-        std::abs(p.airBandGain  - 1.0f) < 0.001f;
+    if (isFlat(p) || sampleRate <= 0.0) return;
 
-    if (isFlat) return;
+    const auto bands = designBands<double>(p, sampleRate);
 
-    // otherwise, process
-    eqChain.process(context);
+    for (size_t i = 0; i < num; ++i)
+    {
+        const auto z1 = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate);
+        const auto z2 = z1 * z1;
+
+        for (const auto& c : bands)
+        {
+            const auto zeros = c[0] + c[1] * z1 + c[2] * z2;
+            const auto poles = c[3] + c[4] * z1 + c[5] * z2;
+            magnitudes[i] *= std::abs(zeros) / juce::jmax(1.0e-12, std::abs(poles));
+        }
+    }
 }
 
+template <typename SampleType>
+BasicEQProcessor<SampleType>::BasicEQProcessor() {}
 
-void EQProcessor::reset()
+template <typename SampleType>
+void BasicEQProcessor<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
 {
-    eqChain.reset();
+    currentSpec = spec;
+    eqChain.prepare(spec);
+
+    const bool wantsDouble = filterState == FilterState::doublePrecision
+                          || (filterState == FilterState::automatic && spec.sampleRate > 48000.0);
+
+    useWideChain = std::is_same_v<SampleType, float> && wantsDouble;
+
+    if (useWideChain)
+    {
+        wideChain.prepare(spec);
+        wideBuffer.setSize((int) spec.numChannels, (int) spec.maximumBlockSize);
+    }
+    else
+    {
+        wideBuffer.setSize(0, 0);
+    }
+
+    reset();
+}
+
+template <typename SampleType>
+void BasicEQProcessor<SampleType>::setParameters(const EQParameters& params)
+{
+    currentParams = params;
     updateFilterCoefficients();
 }
 
-void EQProcessor::updateFilterCoefficients()
+template <typename SampleType>
+void BasicEQProcessor<SampleType>::process(juce::dsp::ProcessContextReplacing<SampleType>& context)
 {
-    const double sr = currentSpec.sampleRate;
+    // bypass if all filters are essentially neutral
+    if (isFlat(currentParams)) return;
 
-    // safety clamps
-    auto safeGain = [](float g)
+    if (! useWideChain)
     {
-        if (std::isnan(g) || std::isinf(g) || g <= 0.0f) return 1.0f;
-        return juce::jlimit(0.05f, 8.0f, g);
-    };
-    auto safeFreq = [sr](float f)
-    {
-        return juce::jlimit(20.0f, (float)(sr * 0.45), f);
-    };
-    auto safeQ = [](float q)
+        eqChain.process(context);
+        return;
+    }
+
+    // widen, filter in double, narrow back
+    auto& block = context.getOutputBlock();
+    const auto numCh = juce::jmin(block.getNumChannels(), (size_t) wideBuffer.getNumChannels());
+    const auto numSm = (int) block.getNumSamples();
+
+    for (size_t ch = 0; ch < numCh; ++ch)
     {
-        return juce::jlimit(0.2f, 4.0f, q);
-    };
+        const auto* src = block.getChannelPointer(ch);
+        auto* dst       = wideBuffer.getWritePointer((int) ch);
 
-    const float lowCut     = safeFreq(currentParams.lowCutFreq);
-    const float lowShelf   = safeFreq(currentParams.lowShelfFreq);
-    const float mid1       = safeFreq(currentParams.mid1Freq);
-    const float mid2       = safeFreq(currentParams.mid2Freq);
-    const float highShelf  = safeFreq(currentParams.highShelfFreq);
-    const float airBand    = safeFreq(currentParams.airBandFreq);
+        for (int i = 0; i < numSm; ++i)
+            dst[i] = (double) src[i];
+    }
 
-    const float lowShelfG  = safeGain(currentParams.lowShelfGain);
-    const float mid1G      = safeGain(currentParams.mid1Gain);
-    const float mid2G      = safeGain(currentParams.mid2Gain);
-    const float highShelfG = safeGain(currentParams.highShelfGain);
-    const float airBandG   = safeGain(currentParams.airBandGain);
+    auto wideBlock = juce::dsp::AudioBlock<double>(wideBuffer)
+                         .getSubsetChannelBlock(0, numCh)
+                         .getSubBlock(0, (size_t) numSm);
+    juce::dsp::ProcessContextReplacing<double> wideContext(wideBlock);
+    wideChain.process(wideContext);
 
-    const float q1 = safeQ(currentParams.mid1Q);
-    const float q2 = safeQ(currentParams.mid2Q);
+    for (size_t ch = 0; ch < numCh; ++ch)
+    {
+        const auto* src = wideBuffer.getReadPointer((int) ch);
+        auto* dst       = block.getChannelPointer(ch);
 
-    // --- update filters
-    *eqChain.get<lowCutIndex>().state   = *juce::dsp::IIR::Coefficients<float>::makeHighPass(sr, lowCut);
+        for (int i = 0; i < numSm; ++i)
+            dst[i] = (SampleType) src[i];
+    }
+}
 
-    *eqChain.get<lowShelfIndex>().state = *juce::dsp::IIR::Coefficients<float>::makeLowShelf(sr, lowShelf, 0.7f, lowShelfG);
 
-    *eqChain.get<mid1Index>().state     = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(sr, mid1, q1, mid1G);
+template <typename SampleType>
+void BasicEQProcessor<SampleType>::reset()
+{
+    eqChain.reset();
+    if (useWideChain)
+        wideChain.reset();
 
-    *eqChain.get<mid2Index>().state     = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(sr, mid2, q2, mid2G);
+    updateFilterCoefficients();
+}
 
-    *eqChain.get<highShelfIndex>().state= *juce::dsp::IIR::Coefficients<float>::makeHighShelf(sr, highShelf, 0.7f, highShelfG);
+template <typename SampleType>
+void BasicEQProcessor<SampleType>::updateFilterCoefficients()
+{
+    if (useWideChain)
+        applyCoefficients(wideChain);
+    else
+        applyCoefficients(eqChain);
+}
 
-    *eqChain.get<airBandIndex>().state  = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(sr, airBand, 0.7f, airBandG);
+template <typename SampleType>
+template <typename StateType>
+void BasicEQProcessor<SampleType>::applyCoefficients(Chain<StateType>& chain)
+{
+    const auto bands = designBands<StateType>(currentParams, currentSpec.sampleRate);
+
+    // --- update filters in place, no allocation
+    *chain.template get<lowCutIndex>().state    = bands[lowCutIndex];
+    *chain.template get<lowShelfIndex>().state  = bands[lowShelfIndex];
+    *chain.template get<mid1Index>().state      = bands[mid1Index];
+    *chain.template get<mid2Index>().state      = bands[mid2Index];
+    *chain.template get<highShelfIndex>().state = bands[highShelfIndex];
+    *chain.template get<airBandIndex>().state   = bands[airBandIndex];
 }
+
+template class BasicEQProcessor<float>;
+template class BasicEQProcessor<double>;
@@ -11,7 +11,9 @@
 #include "DynamicsProcessor.hpp"
 #include "SaturationProcessor.hpp"
 #include "SpatialProcessor.hpp"
-class EQProcessor
+
+// parameters and policies shared by every sample type
+class EQProcessorBase
 {
 public:
     struct EQParameters
@@ -24,51 +26,63 @@ public:
         float airBandFreq   = 12000.0f, airBandGain   = 0.0f;
     };
 
-    EQProcessor();
+    // precision of the biquad state; the low bands lose precision in float
+    // as the rate rises, so automatic switches to double above 48 kHz
+    enum class FilterState { matchSamples, doublePrecision, automatic };
+
+    static constexpr int numBands = 6;
+
+    // unnormalised biquads (b0 b1 b2 a0 a1 a2), one per band in chain order
+    template <typename StateType>
+    using BandCoefficients = std::array<std::array<StateType, 6>, numBands>;
+
+    // the clamped design both the chain and the analyzer curve use
+    template <typename StateType>
+    static BandCoefficients<StateType> designBands(const EQParameters& p, double sampleRate);
+
+    // true when the shaping bands are at unity and the chain is skipped
+    static bool isFlat(const EQParameters& p);
+
+    // linear magnitude of the whole chain at each frequency, as processed
+    static void getMagnitudeResponse(const EQParameters& p, double sampleRate,
+                                     const double* frequencies, double* magnitudes, size_t num);
+};
+
+template <typename SampleType>
+class BasicEQProcessor : public EQProcessorBase
+{
+public:
+    BasicEQProcessor();
 
     void prepare(const juce::dsp::ProcessSpec& spec);
     void setParameters(const EQParameters& params);
-    void process(juce::dsp::ProcessContextReplacing<float>& context);
+    void process(juce::dsp::ProcessContextReplacing<SampleType>& context);
     void reset();
 
+    // takes effect at the next prepare(); no-op for double samples
+    void setFilterState(FilterState newState) { filterState = newState; }
+
     // mode-specific EQ
     void setRhythmEQ(float character, float thump, float body, float shimmer);
     void setLeadEQ(float character, float thump, float body, float shimmer);
     void setCleanEQ(float character, float thump, float body, float shimmer);
 
 private:
-    juce::dsp::ProcessorChain<
-
-    // low cut
-    juce::dsp::ProcessorDuplicator<
-    juce::dsp::IIR::Filter<float>,
-    juce::dsp::IIR::Coefficients<float>>,
-
-    // low shelf
-    juce::dsp::ProcessorDuplicator<
-    juce::dsp::IIR::Filter<float>,
-    juce::dsp::IIR::Coefficients<float>>,
-
-    // mid 1
-    juce::dsp::ProcessorDuplicator<
-    juce::dsp::IIR::Filter<float>,
-    juce::dsp::IIR::Coefficients<float>>,
-
-    // mid 2
-    juce::dsp::ProcessorDuplicator<
-    juce::dsp::IIR::Filter<float>,
-    juce::dsp::IIR::Coefficients<float>>,
-
-    // high shelf
-    juce::dsp::ProcessorDuplicator<
-    juce::dsp::IIR::Filter<float>,
-    juce::dsp::IIR::Coefficients<float>>,
-
-    // air band (high shelf)
-    juce::dsp::ProcessorDuplicator<
-    juce::dsp::IIR::Filter<float>,
-    juce::dsp::IIR::Coefficients<float>>
-    > eqChain;
+    template <typename StateType>
+    using Band = juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<StateType>,
+                                                juce::dsp::IIR::Coefficients<StateType>>;
+
+    // low cut, low shelf, mid 1, mid 2, high shelf, air band (high shelf)
+    template <typename StateType>
+    using Chain = juce::dsp::ProcessorChain<Band<StateType>, Band<StateType>, Band<StateType>,
+                                            Band<StateType>, Band<StateType>, Band<StateType>>;
+
+    Chain<SampleType> eqChain;
+
+    // float audio through double state, converted a block at a time
+    Chain<double> wideChain;
+    juce::AudioBuffer<double> wideBuffer;
+    bool useWideChain = false;
 
     enum
     {
@@ -81,8 +95,15 @@ private:
     };
 
     void updateFilterCoefficients();
+
+    template <typename StateType>
+    void applyCoefficients(Chain<StateType>& chain);
+
     EQParameters currentParams;
+    FilterState filterState = FilterState::automatic;
     juce::dsp::ProcessSpec currentSpec;
 };
 
+using EQProcessor = BasicEQProcessor<float>;
+
 #endif 
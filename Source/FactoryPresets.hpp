@@ -0,0 +1,73 @@
+//
+//  FactoryPresets.hpp
+//  StringSauce
+//
+//  The factory preset table, as plain data so the plugin,
+//  the renderer and the golden renders share one source.
+//  Values are normalised, as the host sees them.
+
+#ifndef FactoryPresets_h
+#define FactoryPresets_h
+#pragma once
+
+#include <array>
+#include <utility>
+#include "ParameterID.hpp"
+
+namespace FactoryPresets
+{
+    struct Preset
+    {
+        const char* name;
+        std::array<std::pair<const char*, float>, 7> values;
+    };
+
+    inline constexpr std::array<Preset, 4> presets
+    {{
+        { "Rhythm Warm",
+        {{
+            { ParamID::CHARACTER, 0.40f },
+            { ParamID::THUMP,     0.70f },
+            { ParamID::BODY,      0.50f },
+            { ParamID::SHIMMER,   0.20f },
+            { ParamID::SPANK,     0.40f },
+            { ParamID::SPACE,     0.00f },
+            { ParamID::MODE,      0.0f }
+        }} },
+
+        { "Rhythm Slappy",
+        {{
+            { ParamID::CHARACTER, 0.199766f },
+            { ParamID::THUMP,     0.475688f },
+            { ParamID::BODY,      0.693409f },
+            { ParamID::SHIMMER,   0.838713f },
+            { ParamID::SPANK,     1.0f },
+            { ParamID::SPACE,     0.0f },
+            { ParamID::MODE,      0.0f }
+        }} },
+
+        { "Lead Air",
+        {{
+            { ParamID::CHARACTER, 0.65f },
+            { ParamID::THUMP,     0.35f },
+            { ParamID::BODY,      0.40f },
+            { ParamID::SHIMMER,   0.75f },
+            { ParamID::SPANK,     0.45f },
+            { ParamID::SPACE,     0.25f },
+            { ParamID::MODE,      0.5f }
+        }} },
+
+        { "Clean Smooth",
+        {{
+            { ParamID::CHARACTER, 0.35f },
+            { ParamID::THUMP,     0.25f },
+            { ParamID::BODY,      0.50f },
+            { ParamID::SHIMMER,   0.55f },
+            { ParamID::SPANK,     0.10f },
+            { ParamID::SPACE,     0.40f },
+            { ParamID::MODE,      1.0f }
+        }} }
+    }};
+}
+
+#endif
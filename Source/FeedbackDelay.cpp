@@ -0,0 +1,173 @@
+//
+//  FeedbackDelay.cpp
+//  StringSauce
+//
+//  Implementation of the ring-buffer feedback delay
+
+#include "FeedbackDelay.hpp"
+
+namespace
+{
+    // compact storage keeps +12 dB of headroom above full scale,
+    // leaving ~84 dB below it for the wet tail
+    constexpr float compactHeadroom = 4.0f;
+    constexpr float toCompact       = 32767.0f / compactHeadroom;
+    constexpr float fromCompact     = compactHeadroom / 32767.0f;
+
+    inline float load(float s) noexcept       { return s; }
+    inline float load(juce::int16 s) noexcept { return (float) s * fromCompact; }
+
+    inline void store(float& dest, float v) noexcept { dest = v; }
+    inline void store(juce::int16& dest, float v) noexcept
+    {
+        dest = (juce::int16) std::floor(juce::jlimit(-32767.0f, 32767.0f, v * toCompact) + 0.5f);
+    }
+}
+
+FeedbackDelay::FeedbackDelay() {}
+
+void FeedbackDelay::prepare(double sampleRate, int maximumDelayInSamples, int maximumBlockSize)
+{
+    maxDelay = juce::jmax((int) minimumDelay, maximumDelayInSamples);
+
+    // one block of slack keeps fixed-delay chunks from being cut at size - delay
+    const int size = juce::nextPowerOfTwo(maxDelay + juce::jmax(1, maximumBlockSize));
+    mask = size - 1;
+
+    if (storage == Storage::compact)
+    {
+        compactBuffer.assign((size_t) size, 0);
+        scratch.assign((size_t) juce::jmax(1, maximumBlockSize), 0.0f);
+        buffer.clear();
+        buffer.shrink_to_fit();
+    }
+    else
+    {
+        buffer.assign((size_t) size, 0.0f);
+        compactBuffer.clear();
+        compactBuffer.shrink_to_fit();
+        scratch.clear();
+        scratch.shrink_to_fit();
+    }
+
+    // time changes glide over this long
+    constexpr double glideTime = 0.15;
+    delay.reset(sampleRate, glideTime);
+
+    reset();
+}
+
+void FeedbackDelay::reset()
+{
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    std::fill(compactBuffer.begin(), compactBuffer.end(), (juce::int16) 0);
+    writePos   = 0;
+    snapToNext = true;
+}
+
+void FeedbackDelay::setDelay(float delayInSamples)
+{
+    // whole samples only, so every glide lands on the fast path
+    const float target = (float) juce::jlimit(minimumDelay, maxDelay, juce::roundToInt(delayInSamples));
+
+    if (snapToNext)
+    {
+        delay.setCurrentAndTargetValue(target);
+        snapToNext = false;
+        return;
+    }
+
+    if (target != delay.getTargetValue())
+        delay.setTargetValue(target);
+}
+
+void FeedbackDelay::process(float* data, int numSamples, float feedback)
+{
+    if (numSamples <= 0) return;
+
+    if (! compactBuffer.empty())
+    {
+        if (delay.isSmoothing()) processGliding(compactBuffer.data(), data, numSamples, feedback);
+        else                     processFixed  (compactBuffer.data(), data, numSamples, feedback);
+    }
+    else if (! buffer.empty())
+    {
+        if (delay.isSmoothing()) processGliding(buffer.data(), data, numSamples, feedback);
+        else                     processFixed  (buffer.data(), data, numSamples, feedback);
+    }
+}
+
+template <typename Sample>
+void FeedbackDelay::processFixed(Sample* ring, float* data, int numSamples, float feedback)
+{
+    const int size = mask + 1;
+    const int d    = (int) delay.getTargetValue();
+
+    // compact chunks are converted through the scratch block
+    const int maxChunk = std::is_same_v<Sample, float> ? numSamples : (int) scratch.size();
+
+    int done = 0;
+
+    while (done < numSamples)
+    {
+        const int readPos = (writePos - d) & mask;
+
+        // no chunk may read what it writes, or cross either ring edge
+        const int chunk = juce::jmin(juce::jmin(numSamples - done, d, size - d),
+                                     juce::jmin(size - writePos, size - readPos, maxChunk));
+
+        Sample* w       = ring + writePos;
+        const Sample* r = ring + readPos;
+        float* io       = data + done;
+
+        if constexpr (std::is_same_v<Sample, float>)
+        {
+            juce::FloatVectorOperations::copy(w, io, chunk);
+            juce::FloatVectorOperations::addWithMultiply(w, r, feedback, chunk);
+            juce::FloatVectorOperations::copy(io, r, chunk);
+        }
+        else
+        {
+            // plain loops so the compiler vectorises the conversions
+            float* y = scratch.data();
+
+            for (int i = 0; i < chunk; ++i) y[i] = load(r[i]);
+            for (int i = 0; i < chunk; ++i) store(w[i], io[i] + feedback * y[i]);
+
+            juce::FloatVectorOperations::copy(io, y, chunk);
+        }
+
+        writePos = (writePos + chunk) & mask;
+        done    += chunk;
+    }
+}
+
+template <typename Sample>
+void FeedbackDelay::processGliding(Sample* ring, float* data, int numSamples, float feedback)
+{
+    const double size = (double) (mask + 1);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const double readPos = (double) writePos - (double) delay.getNextValue() + size;
+        const int idx        = (int) readPos;
+        const float t        = (float) (readPos - (double) idx);
+
+        const float xm1 = load(ring[(idx - 1) & mask]);
+        const float x0  = load(ring[ idx      & mask]);
+        const float x1  = load(ring[(idx + 1) & mask]);
+        const float x2  = load(ring[(idx + 2) & mask]);
+
+        // third-order Lagrange
+        const float tm1 = t - 1.0f, tm2 = t - 2.0f, tp1 = t + 1.0f;
+        const float y = -xm1 * t * tm1 * tm2 / 6.0f
+                      +  x0  * tp1 * tm1 * tm2 * 0.5f
+                      -  x1  * tp1 * t * tm2 * 0.5f
+                      +  x2  * tp1 * t * tm1 / 6.0f;
+
+        store(ring[writePos], data[i] + feedback * y);
+        data[i] = y;
+
+        writePos = (writePos + 1) & mask;
+    }
+}
@@ -0,0 +1,64 @@
+//
+//  FeedbackDelay.hpp
+//  StringSauce
+//
+//  Defines a single-channel ring-buffer feedback delay.
+//  A static delay time is processed in contiguous chunks;
+//  interpolated reads are only used while the time glides.
+
+#ifndef FeedbackDelay_hpp
+#define FeedbackDelay_hpp
+#pragma once
+
+#include <JuceHeader.h>
+
+class FeedbackDelay
+{
+public:
+    // compact keeps the history as int16, halving the ring
+    enum class Storage { full, compact };
+
+    FeedbackDelay();
+
+    // takes effect at the next prepare()
+    void setStorage(Storage s) noexcept { storage = s; }
+
+    void prepare(double sampleRate, int maximumDelayInSamples, int maximumBlockSize);
+    void reset();
+
+    // new target in samples; changes glide instead of jumping
+    void setDelay(float delayInSamples);
+
+    // replaces data with the delayed signal and feeds data + feedback * delayed back in
+    void process(float* data, int numSamples, float feedback);
+
+    bool isGliding() const noexcept { return delay.isSmoothing(); }
+
+    size_t getMemoryUsageBytes() const noexcept
+    {
+        return buffer.size() * sizeof(float)
+             + compactBuffer.size() * sizeof(juce::int16)
+             + scratch.size() * sizeof(float);
+    }
+
+    static constexpr int minimumDelay = 4;
+
+private:
+    template <typename Sample> void processFixed  (Sample* ring, float* data, int numSamples, float feedback);
+    template <typename Sample> void processGliding(Sample* ring, float* data, int numSamples, float feedback);
+
+    Storage storage = Storage::full;
+
+    std::vector<float> buffer;
+    std::vector<juce::int16> compactBuffer;
+    std::vector<float> scratch;
+
+    int mask        = 0;
+    int writePos    = 0;
+    int maxDelay    = minimumDelay;
+    bool snapToNext = true;
+
+    juce::LinearSmoothedValue<float> delay;
+};
+
+#endif
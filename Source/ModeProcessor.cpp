@@ -6,37 +6,69 @@
 #include "ModeProcessor.hpp"
 
 
-ModeProcessor::ModeProcessor()
+template <typename SampleType>
+BasicModeProcessor<SampleType>::BasicModeProcessor()
     : currentMode(ToneMode::RHYTHM)
 {
 }
 
 // prepare mode chains
-void ModeProcessor::prepare(const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
 {
-    rhythmChain.prepare(spec);
-    leadChain.prepare(spec);
-    cleanChain.prepare(spec);
+    // chains never see more than one slice, so their buffers are sized to it
+    const auto hostMax = juce::jmax((juce::uint32) 1, spec.maximumBlockSize);
+    sliceSize = internalBlockSize > 0 ? (size_t) juce::jmin((juce::uint32) internalBlockSize, hostMax)
+                                      : (size_t) hostMax;
+
+    auto chainSpec = spec;
+    chainSpec.maximumBlockSize = (juce::uint32) sliceSize;
+
+    preparedMonoInput = monoInput && spec.numChannels > 1;
+
+    rhythmChain.prepare(chainSpec, preparedMonoInput);
+    leadChain.prepare(chainSpec, preparedMonoInput);
+    cleanChain.prepare(chainSpec, preparedMonoInput);
 
     setProcessingOrder(rhythmChain, ToneMode::RHYTHM);
     setProcessingOrder(leadChain,   ToneMode::LEAD);
     setProcessingOrder(cleanChain,  ToneMode::CLEAN);
 }
 
-void ModeProcessor::setMode(ToneEngine::Mode mode)
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::setMode(ToneEngine::Mode mode)
 {
     currentMode = mode;
 }
 
 // process call
-void ModeProcessor::process(juce::dsp::ProcessContextReplacing<float>& context,
-                            const ToneEngine::EngineParameters& params)
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::process(juce::dsp::ProcessContextReplacing<SampleType>& context,
+                            const ToneEngine::EngineParameters& params,
+                            juce::uint32 parameterGeneration)
 {
     auto& chain = getActiveChain();
-    chain.setParameters(params);
-    chain.process(context);
+
+    if (chain.appliedGeneration != parameterGeneration)
+    {
+        chain.setParameters(params);
+        chain.appliedGeneration = parameterGeneration;
+    }
+
+    auto& fullBlock = context.getOutputBlock();
+    const size_t numSm = fullBlock.getNumSamples();
+    const bool mono    = preparedMonoInput && fullBlock.getNumChannels() > 1;
+
+    // the whole chain runs slice by slice; this also splits host blocks larger than prepared
+    for (size_t start = 0; start < numSm && sliceSize > 0; start += sliceSize)
+    {
+        auto slice = fullBlock.getSubBlock(start, juce::jmin(sliceSize, numSm - start));
+        juce::dsp::ProcessContextReplacing<SampleType> sliceContext(slice);
+        chain.process(sliceContext, mono);
+    }
 
     // global autogain
+    STRINGSAUCE_PROFILE_STAGE(profiler, autoGain);
     const float g = params.outputAutoGain;
 
     if (std::abs(g - 1.0f) > 0.0001f)
@@ -48,22 +80,97 @@ void ModeProcessor::process(juce::dsp::ProcessContextReplacing<float>& context,
         for (size_t ch = 0; ch < numCh; ++ch)
         {
             auto* data = block.getChannelPointer(ch);
-            juce::FloatVectorOperations::multiply(data, g, numSm);
+            juce::FloatVectorOperations::multiply(data, (SampleType) g, numSm);
         }
     }
 }
 
 
 // ======================================================
-void ModeProcessor::reset()
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::reset()
 {
     rhythmChain.reset();
     leadChain.reset();
     cleanChain.reset();
 }
 
+template <typename SampleType>
+float BasicModeProcessor<SampleType>::getShimmerCpuLoad() const
+{
+    switch (currentMode)
+    {
+        case ToneMode::LEAD:   return leadChain.spatial.getShimmerCpuLoad();
+        case ToneMode::CLEAN:  return cleanChain.spatial.getShimmerCpuLoad();
+        default:               return rhythmChain.spatial.getShimmerCpuLoad();
+    }
+}
+
+template <typename SampleType>
+const DynamicsProcessorBase::Meters& BasicModeProcessor<SampleType>::getDynamicsMeters() const
+{
+    switch (currentMode)
+    {
+        case ToneMode::LEAD:   return leadChain.dynamics.getMeters();
+        case ToneMode::CLEAN:  return cleanChain.dynamics.getMeters();
+        default:               return rhythmChain.dynamics.getMeters();
+    }
+}
+
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::setDynamicsMetering(bool shouldMeter)
+{
+    rhythmChain.dynamics.setMeteringEnabled(shouldMeter);
+    leadChain.dynamics.setMeteringEnabled(shouldMeter);
+    cleanChain.dynamics.setMeteringEnabled(shouldMeter);
+}
+
+template <typename SampleType>
+size_t BasicModeProcessor<SampleType>::getSpatialMemoryUsageBytes() const
+{
+    return rhythmChain.spatial.getMemoryUsageBytes()
+         + leadChain.spatial.getMemoryUsageBytes()
+         + cleanChain.spatial.getMemoryUsageBytes();
+}
+
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::setCompactSpatialStorage(bool shouldBeCompact)
+{
+    rhythmChain.spatial.setCompactStorage(shouldBeCompact);
+    leadChain.spatial.setCompactStorage(shouldBeCompact);
+    cleanChain.spatial.setCompactStorage(shouldBeCompact);
+}
+
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::setSpatialStereoMode(SpatialProcessor::StereoMode mode)
+{
+    rhythmChain.spatial.setStereoMode(mode);
+    leadChain.spatial.setStereoMode(mode);
+    cleanChain.spatial.setStereoMode(mode);
+}
+
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::setEQFilterState(EQProcessorBase::FilterState state)
+{
+    rhythmChain.eq.setFilterState(state);
+    leadChain.eq.setFilterState(state);
+    cleanChain.eq.setFilterState(state);
+}
+
+#if STRINGSAUCE_PROFILING
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::setProfiler(StageProfiler* newProfiler)
+{
+    profiler             = newProfiler;
+    rhythmChain.profiler = newProfiler;
+    leadChain.profiler   = newProfiler;
+    cleanChain.profiler  = newProfiler;
+}
+#endif
+
 // get active chain
-ModeProcessor::ModeChain& ModeProcessor::getActiveChain()
+template <typename SampleType>
+typename BasicModeProcessor<SampleType>::ModeChain& BasicModeProcessor<SampleType>::getActiveChain()
 {
     switch (currentMode)
     {
@@ -74,64 +181,110 @@ ModeProcessor::ModeChain& ModeProcessor::getActiveChain()
 }
 
 // assign correct processor order
-void ModeProcessor::setProcessingOrder(ModeChain& chain, ToneEngine::Mode mode)
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::setProcessingOrder(ModeChain& chain, ToneEngine::Mode mode)
 {
     switch (mode)
     {
-        case ToneMode::LEAD:   chain.order = ModeChain::LEAD_ORDER;   break;
-        case ToneMode::CLEAN:  chain.order = ModeChain::CLEAN_ORDER;  break;
-        case ToneMode::RHYTHM: chain.order = ModeChain::RHYTHM_ORDER; break;
+        case ToneMode::LEAD:   chain.processOrder = &LeadOrder::template process<ModeChain>;   break;
+        case ToneMode::CLEAN:  chain.processOrder = &CleanOrder::template process<ModeChain>;  break;
+        case ToneMode::RHYTHM: chain.processOrder = &RhythmOrder::template process<ModeChain>; break;
     }
 }
 
 // prepare mode chain
-void ModeProcessor::ModeChain::prepare(const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::ModeChain::prepare(const juce::dsp::ProcessSpec& spec, bool monoInput)
 {
-    eq.prepare(spec);
+    // with a mono source EQ and saturation only ever see channel 0; they come before spatial in
+    // every order. dynamics runs after it in clean, so it keeps every channel
+    auto preSpec = spec;
+    if (monoInput) preSpec.numChannels = 1;
+
+    eq.prepare(preSpec);
     dynamics.prepare(spec);
-    saturation.prepare(spec);
+    saturation.prepare(preSpec);
     spatial.prepare(spec);
+
+    if constexpr (std::is_same_v<SampleType, float>)
+        spatialScratch.setSize(0, 0);
+    else
+        spatialScratch.setSize((int) spec.numChannels, (int) spec.maximumBlockSize);
+
+    appliedGeneration = 0;
 }
 
-void ModeProcessor::ModeChain::setParameters(const ToneEngine::EngineParameters& params)
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::ModeChain::setParameters(const ToneEngine::EngineParameters& params)
 {
     eq.setParameters(params.eq);
     dynamics.setParameters(params.dynamics);
     saturation.setParameters(params.saturation);
     spatial.setParameters(params.spatial);
+    spatial.setShimmerParameters({ params.effects.shimmerPitch, params.effects.shimmerMix });
+}
+
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::ModeChain::process(juce::dsp::ProcessContextReplacing<SampleType>& context, bool monoInput)
+{
+    auto& block = context.getOutputBlock();
+
+    // stages before spatial only see the channels that carry input
+    auto preBlock = monoInput ? block.getSingleChannelBlock(0) : block;
+    juce::dsp::ProcessContextReplacing<SampleType> pre(preBlock);
+
+    StageContext ctx { pre, context, monoInput, ! monoInput };
+    processOrder(*this, ctx);
 }
 
-void ModeProcessor::ModeChain::process(juce::dsp::ProcessContextReplacing<float>& context)
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::ModeChain::processSpatial(juce::dsp::ProcessContextReplacing<SampleType>& context)
 {
-    switch (order)
+    if constexpr (std::is_same_v<SampleType, float>)
     {
-        case RHYTHM_ORDER:
-            eq.process(context);
-            dynamics.process(context);
-            saturation.process(context);
-            spatial.process(context);
-            break;
-
-        case LEAD_ORDER:
-            saturation.process(context);
-            eq.process(context);
-            dynamics.process(context);
-            spatial.process(context);
-            break;
-
-        case CLEAN_ORDER:
-            eq.process(context);
-            saturation.process(context);
-            spatial.process(context);
-            dynamics.process(context);
-            break;
+        spatial.process(context);
+    }
+    else
+    {
+        // time-based effects gain nothing from double, so narrow around them
+        auto& block = context.getOutputBlock();
+        const auto numCh = juce::jmin(block.getNumChannels(), (size_t) spatialScratch.getNumChannels());
+        const auto numSm = (int) block.getNumSamples();
+
+        for (size_t ch = 0; ch < numCh; ++ch)
+        {
+            const auto* src = block.getChannelPointer(ch);
+            auto* dst       = spatialScratch.getWritePointer((int) ch);
+
+            for (int i = 0; i < numSm; ++i)
+                dst[i] = (float) src[i];
+        }
+
+        auto narrow = juce::dsp::AudioBlock<float>(spatialScratch)
+                          .getSubsetChannelBlock(0, numCh)
+                          .getSubBlock(0, (size_t) numSm);
+        juce::dsp::ProcessContextReplacing<float> narrowContext(narrow);
+        spatial.process(narrowContext);
+
+        for (size_t ch = 0; ch < numCh; ++ch)
+        {
+            const auto* src = spatialScratch.getReadPointer((int) ch);
+            auto* dst       = block.getChannelPointer(ch);
+
+            for (int i = 0; i < numSm; ++i)
+                dst[i] = (SampleType) src[i];
+        }
     }
 }
 
-void ModeProcessor::ModeChain::reset()
+template <typename SampleType>
+void BasicModeProcessor<SampleType>::ModeChain::reset()
 {
     eq.reset();
     dynamics.reset();
     saturation.reset();
     spatial.reset();
 }
+
+template class BasicModeProcessor<float>;
+template class BasicModeProcessor<double>;
@@ -7,39 +7,180 @@
 #include "DynamicsProcessor.hpp"
 #include "SaturationProcessor.hpp"
 #include "SpatialProcessor.hpp"
+#include "StageProfiler.hpp"
 
-class ModeProcessor
+// the whole chain runs in SampleType except spatial, which stays float
+template <typename SampleType>
+class BasicModeProcessor
 {
 public:
-    ModeProcessor();
+    BasicModeProcessor();
 
     void prepare(const juce::dsp::ProcessSpec& spec);
     void setMode(ToneEngine::Mode mode);
 
-    void process(juce::dsp::ProcessContextReplacing<float>& context,
-                 const ToneEngine::EngineParameters& params);
+    // mono source on a wider bus: stages before spatial are prepared for and run on channel 0 only.
+    // takes effect at the next prepare()
+    void setMonoInput(bool isMono) { monoInput = isMono; }
+
+    // 0 processes the host block whole; otherwise slices of this many samples.
+    // takes effect at the next prepare()
+    void setInternalBlockSize(int numSamples) { internalBlockSize = juce::jmax(0, numSamples); }
+    int getInternalBlockSize() const { return internalBlockSize; }
+
+    // params are only pushed to the chain when parameterGeneration moves
+    void process(juce::dsp::ProcessContextReplacing<SampleType>& context,
+                 const ToneEngine::EngineParameters& params,
+                 juce::uint32 parameterGeneration);
 
     void reset();
 
+    // smoothed real-time load of the active chain's shimmer stage
+    float getShimmerCpuLoad() const;
+
+    // the active chain's dynamics metering for the last block
+    const DynamicsProcessorBase::Meters& getDynamicsMeters() const;
+
+    // compressor gain reduction metering in every chain; off by default
+    void setDynamicsMetering(bool shouldMeter);
+
+    // spatial buffers across all three chains
+    size_t getSpatialMemoryUsageBytes() const;
+
+    // delay of the whole chain in host samples, the same in every mode; valid after prepare()
+    int getLatencySamples() const { return rhythmChain.saturation.getLatencySamples(); }
+
+    // internal rate of the spatial wet paths and their latency in host samples
+    double getSpatialWetSampleRate() const { return rhythmChain.spatial.getWetSampleRate(); }
+    int getSpatialWetLatencySamples() const { return rhythmChain.spatial.getWetLatencySamples(); }
+
+    // int16 delay history in every chain; applied at the next prepare()
+    void setCompactSpatialStorage(bool shouldBeCompact);
+
+    // L/R or M/S spatial processing in every chain
+    void setSpatialStereoMode(SpatialProcessor::StereoMode mode);
+
+    // EQ biquad state precision in every chain; applied at the next prepare()
+    void setEQFilterState(EQProcessorBase::FilterState state);
+
+   #if STRINGSAUCE_PROFILING
+    // stage timings go here; nullptr stops timing
+    void setProfiler(StageProfiler* newProfiler);
+   #endif
+
 private:
     ToneMode currentMode = ToneMode::RHYTHM;
+    bool monoInput         = false;
+    bool preparedMonoInput = false;
+
+    int internalBlockSize = 0;
+    size_t sliceSize      = 0;
+
+   #if STRINGSAUCE_PROFILING
+    StageProfiler* profiler = nullptr;
+   #endif
+
+    // what a stage sees: the input channels until spatial has widened the block
+    struct StageContext
+    {
+        juce::dsp::ProcessContextReplacing<SampleType>& pre;
+        juce::dsp::ProcessContextReplacing<SampleType>& full;
+        bool monoInput = false;
+        bool widened   = false;
+
+        juce::dsp::ProcessContextReplacing<SampleType>& current() { return widened ? full : pre; }
+    };
+
+    // one tag per stage; a new stage only needs a tag and a place in an order below
+    struct EQStage
+    {
+        template <typename Chain>
+        static void process(Chain& c, StageContext& ctx)
+        {
+            STRINGSAUCE_PROFILE_STAGE(c.profiler, eq);
+            c.eq.process(ctx.current());
+        }
+    };
+
+    struct DynamicsStage
+    {
+        template <typename Chain>
+        static void process(Chain& c, StageContext& ctx)
+        {
+            STRINGSAUCE_PROFILE_STAGE(c.profiler, dynamics);
+            c.dynamics.process(ctx.current());
+        }
+    };
+
+    struct SaturationStage
+    {
+        template <typename Chain>
+        static void process(Chain& c, StageContext& ctx)
+        {
+            STRINGSAUCE_PROFILE_STAGE(c.profiler, saturation);
+            c.saturation.process(ctx.current());
+        }
+    };
+
+    // copies a mono input across before widening, so everything after runs on all channels
+    struct SpatialStage
+    {
+        template <typename Chain>
+        static void process(Chain& c, StageContext& ctx)
+        {
+            STRINGSAUCE_PROFILE_STAGE(c.profiler, spatial);
+
+            if (ctx.monoInput && ! ctx.widened)
+            {
+                auto& block = ctx.full.getOutputBlock();
+                const auto numSm = (int) block.getNumSamples();
+
+                for (size_t ch = 1; ch < block.getNumChannels(); ++ch)
+                    juce::FloatVectorOperations::copy(block.getChannelPointer(ch), block.getChannelPointer(0), numSm);
+            }
+
+            ctx.widened = true;
+            c.processSpatial(ctx.full);
+        }
+    };
+
+    // stages folded in order at compile time
+    template <typename... Stages>
+    struct StageOrder
+    {
+        template <typename Chain>
+        static void process(Chain& c, StageContext& ctx) { (Stages::process(c, ctx), ...); }
+    };
+
+    using RhythmOrder = StageOrder<EQStage, DynamicsStage, SaturationStage, SpatialStage>;
+    using LeadOrder   = StageOrder<SaturationStage, EQStage, DynamicsStage, SpatialStage>;
+    using CleanOrder  = StageOrder<EQStage, SaturationStage, SpatialStage, DynamicsStage>;
 
     struct ModeChain
     {
-        EQProcessor eq;
-        DynamicsProcessor dynamics;
-        SaturationProcessor saturation;
+        BasicEQProcessor<SampleType> eq;
+        BasicDynamicsProcessor<SampleType> dynamics;
+        BasicSaturationProcessor<SampleType> saturation;
         SpatialProcessor spatial;
 
-        enum ProcessingOrder {
-            RHYTHM_ORDER, // EQ -> Dynamics -> Saturation -> spatial
-            LEAD_ORDER,   // Saturation -> EQ -> Dynamics -> Spatial
-            CLEAN_ORDER   // EQ -> Saturation -> Spatial -> Dynamics
-        } order = RHYTHM_ORDER;
+        // spatial's view of a double block; unused for float
+        juce::AudioBuffer<float> spatialScratch;
+
+       #if STRINGSAUCE_PROFILING
+        StageProfiler* profiler = nullptr;
+       #endif
+
+        // set once per mode from one of the orders above
+        using ProcessFn = void (*)(ModeChain&, StageContext&);
+        ProcessFn processOrder = &RhythmOrder::template process<ModeChain>;
 
-        void prepare(const juce::dsp::ProcessSpec& spec);
+        // generation of the parameters last applied; 0 forces the next update
+        juce::uint32 appliedGeneration = 0;
+
+        void prepare(const juce::dsp::ProcessSpec& spec, bool monoInput);
         void setParameters(const ToneEngine::EngineParameters& params);
-        void process(juce::dsp::ProcessContextReplacing<float>& context);
+        void process(juce::dsp::ProcessContextReplacing<SampleType>& context, bool monoInput);
+        void processSpatial(juce::dsp::ProcessContextReplacing<SampleType>& context);
         void reset();
     };
 
@@ -49,4 +190,6 @@ private:
     void setProcessingOrder(ModeChain& chain, ToneEngine::Mode mode);
 };
 
+using ModeProcessor = BasicModeProcessor<float>;
+
 #endif
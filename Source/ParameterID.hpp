@@ -17,6 +17,8 @@ namespace ParamID
     inline constexpr const char* SPACE     = "space";
     inline constexpr const char* SPANK     = "spank";
     inline constexpr const char* MODE      = "mode";
+    inline constexpr const char* SYNC      = "sync";
+    inline constexpr const char* BYPASS    = "bypass";
 }
 
 #endif
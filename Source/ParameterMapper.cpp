@@ -386,8 +386,8 @@ SpatialProcessor::SpatialParameters ParameterMapper::mapSpatial(
 
     sp.delayMix = juce::jlimit(0.f, maxDlyMix, maxDlyMix * amt * dW);
 
-    sp.delayTimeLeft  = dlyBase + amt * dlySpan;
-    sp.delayTimeRight = sp.delayTimeLeft * 1.5f;
+    sp.delayTimeLeft  = juce::jmin(SpatialProcessor::maxDelayTimeMs, dlyBase + amt * dlySpan);
+    sp.delayTimeRight = juce::jmin(SpatialProcessor::maxDelayTimeMs, sp.delayTimeLeft * 1.5f);
     sp.delayFeedback  = juce::jmap(amt, 0.f, 1.f, fbMin, fbMax);
 
     float choInfluence = amt;
@@ -407,6 +407,40 @@ SpatialProcessor::SpatialParameters ParameterMapper::mapSpatial(
     return sp;
 }
 
+// ==========================================================
+// TEMPO SYNC
+// ==========================================================
+float ParameterMapper::quantizeDelayToTempo(float delayMs, double bpm)
+{
+    if (bpm <= 0.0 || delayMs <= 0.0f) return delayMs;
+
+    // in quarter notes: 1/16, 1/8T, 1/8, 1/4T, 1/8D, 1/4, 1/2T, 1/4D, 1/2
+    static constexpr double divisions[] = { 0.25, 1.0 / 3.0, 0.5, 2.0 / 3.0, 0.75, 1.0, 4.0 / 3.0, 1.5, 2.0 };
+
+    const double beatMs = 60000.0 / bpm;
+    const double maxMs  = SpatialProcessor::maxDelayTimeMs;
+    double best         = juce::jmin(divisions[0] * beatMs, maxMs);
+    double bestDist     = std::abs(std::log(best / delayMs));
+
+    // nearest on a log scale, so halving and doubling weigh the same;
+    // nothing longer than the delay lines can hold
+    for (auto d : divisions)
+    {
+        const double candidate = d * beatMs;
+        if (candidate > maxMs) break;
+
+        const double dist      = std::abs(std::log(candidate / delayMs));
+
+        if (dist < bestDist)
+        {
+            best     = candidate;
+            bestDist = dist;
+        }
+    }
+
+    return (float) best;
+}
+
 SaturationProcessor::Type ParameterMapper::selectSaturationType(
     float character, Mode mode)
 {
@@ -20,6 +20,9 @@ public:
 
     static SpatialProcessor::SpatialParameters mapSpatial(float body, float shimmer, float space, ToneMode mode);
 
+    // snaps a delay time to the nearest note division at the given tempo
+    static float quantizeDelayToTempo(float delayMs, double bpm);
+
 private:
     static SaturationProcessor::Type selectSaturationType(float character, ToneMode mode);
 };
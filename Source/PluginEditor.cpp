@@ -120,6 +120,15 @@ StringSauceAudioProcessorEditor::StringSauceAudioProcessorEditor (StringSauceAud
         };
     }
 
+    // analyzer overlay toggle
+    addChildComponent(analyzerView);
+    addAndMakeVisible(analyzerButton);
+    analyzerButton.setClickingTogglesState(true);
+    analyzerButton.onClick = [this]()
+    {
+        analyzerView.setVisible(analyzerButton.getToggleState());
+    };
+
     // preset Bar
     startTimerHz(10);
     addAndMakeVisible(presetBox);
@@ -171,12 +180,7 @@ StringSauceAudioProcessorEditor::StringSauceAudioProcessorEditor (StringSauceAud
         auto* pm = audioProcessor.presetManager.get();
         if (!pm) return;
 
-        auto presetDir = juce::File::getSpecialLocation(
-            juce::File::userDocumentsDirectory)
-            .getChildFile("StringSauce")
-            .getChildFile("Presets");
-
-        presetDir.createDirectory();
+        auto presetDir = pm->getPresetDirectory();
 
         auto chooser = std::make_shared<juce::FileChooser>(
             "Save preset...",
@@ -275,6 +279,10 @@ void StringSauceAudioProcessorEditor::resized()
         debugButton.setBounds(debugArea.reduced(4));
     }
 
+    // analyzer button + overlay over the content area
+    analyzerButton.setBounds(presetBar.removeFromLeft(80).reduced(4));
+    analyzerView.setBounds(bounds);
+
     // preset bar
     {
         auto area = presetBar.reduced(8);
@@ -7,6 +7,7 @@
 #include "UIFactory.hpp"
 #include "UILayout.hpp"
 #include "DebugWindow.hpp"
+#include "AnalyzerView.hpp"
 
 
 class StringSauceAudioProcessorEditor :
@@ -45,6 +46,10 @@ private:
     std::unique_ptr<DebugWindow> debugWindow;
     juce::TextButton debugButton { "Debug" };
 
+    // spectrum overlay, hidden until toggled
+    AnalyzerView analyzerView { audioProcessor };
+    juce::TextButton analyzerButton { "Analyzer" };
+
     // preset bar
     juce::ComboBox  presetBox;
     juce::TextButton saveButton   { "Save" };
@@ -1,6 +1,26 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "ParameterID.hpp"
+#include "FactoryPresets.hpp"
+
+namespace
+{
+    // peak and RMS of the first two channels, zero for channels that are not there
+    template <typename SampleType>
+    void measureLevels (const juce::AudioBuffer<SampleType>& buffer, int numChannels,
+                        std::array<float, 2>& peak, std::array<float, 2>& rms)
+    {
+        const int numCh = juce::jmin (numChannels, buffer.getNumChannels());
+        const int numSm = buffer.getNumSamples();
+
+        for (int ch = 0; ch < (int) peak.size(); ++ch)
+        {
+            const bool present = ch < numCh && numSm > 0;
+            peak[(size_t) ch]  = present ? (float) buffer.getMagnitude (ch, 0, numSm) : 0.0f;
+            rms[(size_t) ch]   = present ? (float) buffer.getRMSLevel (ch, 0, numSm) : 0.0f;
+        }
+    }
+}
 
 // ============================================================
 // Constructor
@@ -17,10 +37,37 @@ StringSauceAudioProcessor::StringSauceAudioProcessor()
       )
 #endif
 {
+    bypassParameter = dynamic_cast<juce::AudioParameterBool*> (apvts.getParameter (ParamID::BYPASS));
+
+   #if STRINGSAUCE_PROFILING
+    modeProcessor.setProfiler (&profiler);
+    modeProcessorDouble.setProfiler (&profiler);
+   #endif
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    const char* timedIds[] = { ParamID::CHARACTER, ParamID::THUMP, ParamID::BODY, ParamID::SHIMMER,
+                               ParamID::SPANK, ParamID::SPACE, ParamID::MODE, ParamID::SYNC };
+
+    for (size_t i = 0; i < blockTimerParameters.size(); ++i)
+        blockTimerParameters[i] = apvts.getRawParameterValue (timedIds[i]);
+   #endif
+
+    for (size_t i = 0; i < stateParameters.size(); ++i)
+    {
+        stateParameters[i] = apvts.getParameter (PluginState::parameterIds[i]);
+        apvts.addParameterListener (PluginState::parameterIds[i], this);
+    }
+
     presetManager = std::make_unique<PresetManager>(apvts, "StringSauce");
     registerFactoryPresets();
 }
 
+StringSauceAudioProcessor::~StringSauceAudioProcessor ()
+{
+    for (auto* id : PluginState::parameterIds)
+        apvts.removeParameterListener (id, this);
+}
+
 // ============================================================
 void StringSauceAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
@@ -29,12 +76,60 @@ void StringSauceAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
         static_cast<juce::uint32> (samplesPerBlock),
         static_cast<juce::uint32> (getTotalNumOutputChannels())
     };
-    inputGain.prepare (spec);
-    outputGain.prepare (spec);
-    inputGain.setGainDecibels (0.0f);
-    outputGain.setGainDecibels (0.0f);
+    const bool monoInput = getTotalNumInputChannels() == 1 && getTotalNumOutputChannels() > 1;
+
+    // a mono source is widened by spatial alone, so its chorus and reverb run on the side channel
+    const auto stereoMode = monoInput ? SpatialProcessor::StereoMode::MidSide
+                                      : SpatialProcessor::StereoMode::LeftRight;
+
     toneEngine.prepare (spec);
-    modeProcessor.prepare (spec);
+
+    silenceGate.prepare (sampleRate);
+    analyzer.prepare (sampleRate);
+
+   #if STRINGSAUCE_PROFILING
+    profiler.prepare (sampleRate);
+   #endif
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    blockTimer.prepare (sampleRate);
+   #endif
+
+    if (isUsingDoublePrecision())
+    {
+        inputGainDouble.prepare (spec);
+        outputGainDouble.prepare (spec);
+        inputGainDouble.setGainDecibels (0.0);
+        outputGainDouble.setGainDecibels (0.0);
+        modeProcessorDouble.setMonoInput (monoInput);
+        modeProcessorDouble.setSpatialStereoMode (stereoMode);
+        modeProcessorDouble.prepare (spec);
+
+        // reported so the host compensates it, and matched by the bypass's dry path
+        const int latency = modeProcessorDouble.getLatencySamples();
+        setLatencySamples (latency);
+        softBypassDouble.prepare (sampleRate, (int) spec.numChannels, samplesPerBlock, latency);
+        softBypassDouble.setLatency (latency);
+    }
+    else
+    {
+        inputGain.prepare (spec);
+        outputGain.prepare (spec);
+        inputGain.setGainDecibels (0.0f);
+        outputGain.setGainDecibels (0.0f);
+        modeProcessor.setMonoInput (monoInput);
+        modeProcessor.setSpatialStereoMode (stereoMode);
+        modeProcessor.prepare (spec);
+
+        const int latency = modeProcessor.getLatencySamples();
+        setLatencySamples (latency);
+        softBypass.prepare (sampleRate, (int) spec.numChannels, samplesPerBlock, latency);
+        softBypass.setLatency (latency);
+    }
+
+    // wet latency depends on the rate, so the tail is redone here as well
+    updateTailLength (toneEngine.getCurrentParameters());
+    tailGeneration = 0;
 }
 
 // ============================================================
@@ -46,6 +141,73 @@ void StringSauceAudioProcessor::releaseResources ()
 void StringSauceAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                               juce::MidiBuffer& /*midi*/)
 {
+    STRINGSAUCE_REALTIME_SCOPE;
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    const auto blockStart = BlockTimer::startBlock();
+   #endif
+
+    processSamples (buffer, modeProcessor, inputGain, outputGain, softBypass);
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    blockTimer.endBlock (blockStart, buffer.getNumSamples(), [this] { return getBlockTimerState(); });
+   #endif
+}
+
+void StringSauceAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer,
+                                              juce::MidiBuffer& /*midi*/)
+{
+    STRINGSAUCE_REALTIME_SCOPE;
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    const auto blockStart = BlockTimer::startBlock();
+   #endif
+
+    processSamples (buffer, modeProcessorDouble, inputGainDouble, outputGainDouble, softBypassDouble);
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    blockTimer.endBlock (blockStart, buffer.getNumSamples(), [this] { return getBlockTimerState(); });
+   #endif
+}
+
+#if STRINGSAUCE_BLOCK_TIMING
+BlockTimer::State StringSauceAudioProcessor::getBlockTimerState () const
+{
+    BlockTimer::State state;
+
+    for (size_t m = 0; m < state.macros.size(); ++m)
+        state.macros[m] = blockTimerParameters[m]->load();
+
+    state.mode     = static_cast<int> (blockTimerParameters[6]->load());
+    state.sync     = blockTimerParameters[7]->load() > 0.5f;
+    state.bypassed = bypassParameter != nullptr && bypassParameter->get();
+    return state;
+}
+#endif
+
+// ============================================================
+template <typename SampleType>
+void StringSauceAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer,
+                                                BasicModeProcessor<SampleType>& chain,
+                                                juce::dsp::Gain<SampleType>& inGain,
+                                                juce::dsp::Gain<SampleType>& outGain,
+                                                SoftBypass<SampleType>& bypass)
+{
+    // the bypass keeps one prepared block of dry signal, so longer host blocks run in pieces
+    const int numSamples = buffer.getNumSamples();
+    const int chunkSize  = bypass.getMaximumBlockSize();
+
+    if (numSamples > chunkSize && chunkSize > 0)
+    {
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            juce::AudioBuffer<SampleType> chunk (buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                                 start, juce::jmin (chunkSize, numSamples - start));
+            processSamples (chunk, chain, inGain, outGain, bypass);
+        }
+        return;
+    }
+
     juce::ScopedNoDenormals noDenormals;
 
     const int totalNumInputChannels  = getTotalNumInputChannels();
@@ -55,8 +217,39 @@ void StringSauceAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (int ch = totalNumInputChannels; ch < totalNumOutputChannels; ++ch)
         buffer.clear (ch, 0, buffer.getNumSamples());
 
-    juce::dsp::AudioBlock<float> block (buffer);
-    juce::dsp::ProcessContextReplacing<float> context (block);
+    juce::dsp::AudioBlock<SampleType> block (buffer);
+    juce::dsp::ProcessContextReplacing<SampleType> context (block);
+
+    // input gain only touches channels that carry input
+    auto inputBlock = block.getSubsetChannelBlock (0, (size_t) juce::jmin (totalNumInputChannels, totalNumOutputChannels));
+    juce::dsp::ProcessContextReplacing<SampleType> inputContext (inputBlock);
+
+    auto& snapshot = telemetry.getWriteSlot();
+    measureLevels (buffer, totalNumInputChannels, snapshot.inputPeak, snapshot.inputRms);
+    analyzer.pushPre (buffer, totalNumInputChannels);
+
+    // 0. Bypass keeps the delayed input; once faded out the chain is skipped
+    if (! bypass.pushDry (block, totalNumInputChannels, bypassParameter != nullptr && bypassParameter->get()))
+    {
+        bypass.mix (block);
+        publishTelemetry (buffer, {});
+        return;
+    }
+
+    if (bypass.takeResetRequest())
+    {
+        chain.reset();
+        silenceGate.reset();
+    }
+
+    // Sleep while nothing comes in and nothing rings out
+    if (silenceGate.shouldSkip (inputBlock))
+    {
+        buffer.clear();
+        bypass.mix (block);
+        publishTelemetry (buffer, {});
+        return;
+    }
 
     // 1. Fetch parameter values
     const float character = *apvts.getRawParameterValue ("character");
@@ -66,26 +259,72 @@ void StringSauceAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     const float spank     = *apvts.getRawParameterValue ("spank");
     const float space     = *apvts.getRawParameterValue ("space");
     const int   modeIndex = static_cast<int> (*apvts.getRawParameterValue ("mode"));
+    const bool  sync      = *apvts.getRawParameterValue ("sync") > 0.5f;
+
+    // host tempo, read once per block
+    if (auto* playHead = getPlayHead())
+        if (auto position = playHead->getPosition())
+            if (auto bpm = position->getBpm())
+                hostBpm = *bpm;
 
     const ToneEngine::Mode mode = static_cast<ToneEngine::Mode> (modeIndex);
 
     // 2. Input Gain
-    inputGain.process (context);
+    inGain.process (inputContext);
 
     // 3. Update Tone Engine (macro -> sub-parameters)
     // this calls ParameterMapper::mapEQ/mapDynamics/mapSaturation/mapSpatial
     // and writes the results into toneEngine.currentParams.
-    toneEngine.updateParameters (character, thump, body, shimmer, spank, space, mode);
+    {
+        STRINGSAUCE_PROFILE_STAGE (&profiler, toneEngine);
+        toneEngine.setTempoSync (sync, hostBpm);
+        toneEngine.updateParameters (character, thump, body, shimmer, spank, space, mode);
+    }
     const auto& params = toneEngine.getCurrentParameters();
 
+    if (toneEngine.getParameterGeneration() != tailGeneration)
+    {
+        updateTailLength (params);
+        tailGeneration = toneEngine.getParameterGeneration();
+    }
+
     // 4. Mode Processor
     // selects Rhythm / Lead / Clean chain and process the block
     // through EQ, Dynamics, Saturation, Spatial in the appropriate order.
-    modeProcessor.setMode (mode);
-    modeProcessor.process (context, params);
+    chain.setMode (mode);
+    chain.setDynamicsMetering (dynamicsMetering.load (std::memory_order_relaxed));
+    chain.process (context, params, toneEngine.getParameterGeneration());
 
     // 5. Output Gain
-    outputGain.process (context);
+    outGain.process (context);
+
+    // 6. Once everything has decayed, clear what is left so waking starts from rest
+    if (silenceGate.processed (block))
+        chain.reset();
+
+    // 7. Crossfade against the dry path while bypass changes
+    bypass.mix (block);
+
+    publishTelemetry (buffer, chain.getDynamicsMeters());
+
+   #if STRINGSAUCE_PROFILING
+    profiler.endBlock (buffer.getNumSamples());
+   #endif
+}
+
+template <typename SampleType>
+void StringSauceAudioProcessor::publishTelemetry (const juce::AudioBuffer<SampleType>& buffer,
+                                                  const DynamicsProcessorBase::Meters& dynamics)
+{
+    auto& snapshot = telemetry.getWriteSlot();
+
+    snapshot.params     = toneEngine.getCurrentParameters();
+    snapshot.dynamics   = dynamics;
+    snapshot.blockCount = ++telemetryBlocks;
+    measureLevels (buffer, getTotalNumOutputChannels(), snapshot.outputPeak, snapshot.outputRms);
+
+    telemetry.publish();
+    analyzer.pushPost (buffer, getTotalNumOutputChannels());
 }
 
 // ============================================================
@@ -97,7 +336,11 @@ bool StringSauceAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
         return false;
 
    #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    // matching buses, or a mono source widened by the spatial stage
+    const bool monoToStereo = layouts.getMainInputChannelSet()  == juce::AudioChannelSet::mono()
+                           && layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo();
+
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet() && ! monoToStereo)
         return false;
    #endif
     return true;
@@ -119,21 +362,56 @@ StringSauceAudioProcessor::createParameterLayout ()
     params.push_back (std::make_unique<juce::AudioParameterFloat> ("space",     "Space",     range, minDef));
     params.push_back (std::make_unique<juce::AudioParameterChoice> (
         "mode", "Mode", juce::StringArray { "Rhythm", "Lead", "Clean" }, 0));
+    params.push_back (std::make_unique<juce::AudioParameterBool> ("sync", "Tempo Sync", false));
+    params.push_back (std::make_unique<juce::AudioParameterBool> (ParamID::BYPASS, "Bypass", false));
     return { params.begin(), params.end() };
 }
 
 // ============================================================
+// hosts autosave every instance, so the blob is only rebuilt after something changed
 void StringSauceAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    if (auto state = apvts.copyState().createXml())
-        copyXmlToBinary (*state, destData);
+    const juce::ScopedLock lock (stateLock);
+    const auto& presetName = presetManager->getCurrentPresetName();
+
+    // cleared before the values are read, so a change landing meanwhile marks it again
+    if (stateDirty.exchange (false) || presetName != cachedPresetName)
+    {
+        PluginState::Contents contents;
+
+        for (size_t i = 0; i < stateParameters.size(); ++i)
+            if (auto* param = stateParameters[i])
+                contents.values[i] = param->convertFrom0to1 (param->getValue());
+
+        contents.presetName = presetName;
+        PluginState::write (contents, cachedState);
+        cachedPresetName = presetName;
+    }
+
+    destData.replaceAll (cachedState.getData(), cachedState.getSize());
 }
 
 void StringSauceAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    if (auto xml = getXmlFromBinary (data, sizeInBytes))
-        if (xml->hasTagName (apvts.state.getType()))
-            apvts.replaceState (juce::ValueTree::fromXml (*xml));
+    PluginState::Contents contents;
+
+    if (! PluginState::read (data, sizeInBytes, apvts.state.getType().toString(), contents))
+        return;
+
+    // parameters missing from the blob keep their current values, as replaceState did
+    for (size_t i = 0; i < stateParameters.size(); ++i)
+        if (auto* param = stateParameters[i]; param != nullptr && contents.present[i])
+            param->setValueNotifyingHost (param->convertTo0to1 (contents.values[i]));
+
+    if (contents.presetName.isNotEmpty())
+        presetManager->setCurrentPresetName (contents.presetName);
+
+    stateDirty = true;
+}
+
+void StringSauceAudioProcessor::parameterChanged (const juce::String&, float)
+{
+    stateDirty = true;
 }
 
 // ============================================================
@@ -171,7 +449,20 @@ bool StringSauceAudioProcessor::isMidiEffect () const
 
 double StringSauceAudioProcessor::getTailLengthSeconds () const
 {
-    return 0.0;
+    return tailSeconds.load();
+}
+
+void StringSauceAudioProcessor::updateTailLength (const ToneEngine::EngineParameters& params)
+{
+    const double sr      = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+    const double latency = (double) (getSpatialWetLatencySamples() + getLatencySamples()) / sr;
+    const double tail    = SpatialProcessor::estimateTailSeconds (params.spatial) + latency;
+
+    tailSeconds.store (tail);
+
+    // the gate measures the output itself; it only has to bridge a quiet gap between echoes
+    const double gap = SpatialProcessor::longestTailGapSeconds (params.spatial) + latency;
+    silenceGate.setHoldSeconds (juce::jmax (0.05, juce::jmin (tail, gap + 0.05)));
 }
 
 // ============================================================
@@ -194,50 +485,6 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter ()
 //==============================================================================
 void StringSauceAudioProcessor::registerFactoryPresets()
 {
-    using namespace ParamID;
-
-    presetManager->addFactoryPreset("Rhythm Warm",
-    {
-        { CHARACTER, 0.40f },
-        { THUMP,     0.70f },
-        { BODY,      0.50f },
-        { SHIMMER,   0.20f },
-        { SPANK,     0.40f },
-        { SPACE,     0.00f },
-        { MODE,      0.0f }
-    });
-    
-    presetManager->addFactoryPreset("Rhythm Slappy",
-    {
-        { CHARACTER, 0.199766f },
-        { THUMP,     0.475688f },
-        { BODY,      0.693409f },
-        { SHIMMER,   0.838713f },
-        { SPANK,     1.0f },
-        { SPACE,     0.0f },
-        { MODE,      0.0f }
-
-    });
-
-    presetManager->addFactoryPreset("Lead Air",
-    {
-        { CHARACTER, 0.65f },
-        { THUMP,     0.35f },
-        { BODY,      0.40f },
-        { SHIMMER,   0.75f },
-        { SPANK,     0.45f },
-        { SPACE,     0.25f },
-        { MODE,      0.5f }
-    });
-
-    presetManager->addFactoryPreset("Clean Smooth",
-    {
-        { CHARACTER, 0.35f },
-        { THUMP,     0.25f },
-        { BODY,      0.50f },
-        { SHIMMER,   0.55f },
-        { SPANK,     0.10f },
-        { SPACE,     0.40f },
-        { MODE,      1.0f }   
-    });
+    for (const auto& preset : FactoryPresets::presets)
+        presetManager->addFactoryPreset (preset.name, preset.values);
 }
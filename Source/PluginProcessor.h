@@ -5,17 +5,28 @@
 #include "ModeProcessor.hpp"
 #include "SpatialProcessor.hpp"
 #include "PresetManager.hpp"
+#include "SilenceGate.hpp"
+#include "SoftBypass.hpp"
+#include "Telemetry.hpp"
+#include "SpectrumAnalyzer.hpp"
+#include "RealtimeGuard.hpp"
+#include "BlockTimer.hpp"
+#include "PluginState.hpp"
 
-class StringSauceAudioProcessor : public juce::AudioProcessor
+class StringSauceAudioProcessor : public juce::AudioProcessor,
+                                  private juce::AudioProcessorValueTreeState::Listener
 {
 public:
     StringSauceAudioProcessor();
-    ~StringSauceAudioProcessor() override = default;
+    ~StringSauceAudioProcessor() override;
 
     // JUCE Overrides
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources () override;
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing () const override { return true; }
+    juce::AudioProcessorParameter* getBypassParameter () const override { return bypassParameter; }
 
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
     juce::AudioProcessorEditor* createEditor () override;
@@ -41,9 +52,70 @@ public:
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", createParameterLayout() };
 
     ToneEngine toneEngine;
-    const ToneEngine::EngineParameters& getEngineParams () const
+
+    // message thread only: newest block's mapped parameters and meters, never blocks the audio thread
+    const TelemetrySnapshot& getTelemetry ()
+    {
+        telemetry.update();
+        return telemetry.getReadSlot();
+    }
+
+    // any thread; compressor gain reduction in the telemetry reads 0 while off
+    void setDynamicsMeteringEnabled (bool shouldMeter) noexcept { dynamicsMetering.store (shouldMeter, std::memory_order_relaxed); }
+
+    // pre/post spectra; idle until a view enables it
+    SpectrumAnalyzer& getAnalyzer () { return analyzer; }
+
+    // getters read whichever precision the host is running
+    float getShimmerCpuLoad () const
+    {
+        return isUsingDoublePrecision() ? modeProcessorDouble.getShimmerCpuLoad() : modeProcessor.getShimmerCpuLoad();
+    }
+    size_t getSpatialMemoryUsageBytes () const
+    {
+        return isUsingDoublePrecision() ? modeProcessorDouble.getSpatialMemoryUsageBytes() : modeProcessor.getSpatialMemoryUsageBytes();
+    }
+    double getSpatialWetSampleRate () const
     {
-        return toneEngine.getCurrentParameters();
+        return isUsingDoublePrecision() ? modeProcessorDouble.getSpatialWetSampleRate() : modeProcessor.getSpatialWetSampleRate();
+    }
+    int getSpatialWetLatencySamples () const
+    {
+        return isUsingDoublePrecision() ? modeProcessorDouble.getSpatialWetLatencySamples() : modeProcessor.getSpatialWetLatencySamples();
+    }
+
+   #if STRINGSAUCE_PROFILING
+    const StageProfiler& getProfiler () const { return profiler; }
+   #endif
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    // whole-block times, overruns and spike snapshots
+    BlockTimer& getBlockTimer () { return blockTimer; }
+   #endif
+
+    // blocks skipped while the input and every tail were silent
+    juce::uint64 getSleptBlocks () const { return silenceGate.getSleptBlocks(); }
+
+    // setters apply to both precisions
+    // halves delay-line memory at ~84 dB tail SNR; takes effect at the next prepareToPlay
+    void setCompactSpatialStorage (bool shouldBeCompact)
+    {
+        modeProcessor.setCompactSpatialStorage (shouldBeCompact);
+        modeProcessorDouble.setCompactSpatialStorage (shouldBeCompact);
+    }
+
+    // run the chain in fixed slices (e.g. 32/64/128), 0 for whole host blocks; applied at the next prepareToPlay
+    void setInternalBlockSize (int numSamples)
+    {
+        modeProcessor.setInternalBlockSize (numSamples);
+        modeProcessorDouble.setInternalBlockSize (numSamples);
+    }
+
+    // EQ biquad state in float, double, or double above 48 kHz (default); applied at the next prepareToPlay
+    void setEQFilterState (EQProcessorBase::FilterState state)
+    {
+        modeProcessor.setEQFilterState (state);
+        modeProcessorDouble.setEQFilterState (state);
     }
 
     // presets
@@ -54,6 +126,65 @@ private:
     // DSP Components
     ModeProcessor modeProcessor;
     juce::dsp::Gain<float> inputGain, outputGain;
+
+    // host-visible bypass, crossfaded against the latency-aligned input
+    juce::AudioParameterBool* bypassParameter = nullptr;
+    SoftBypass<float> softBypass;
+    SoftBypass<double> softBypassDouble;
+
+   #if STRINGSAUCE_PROFILING
+    StageProfiler profiler;
+   #endif
+
+   #if STRINGSAUCE_BLOCK_TIMING
+    BlockTimer blockTimer;
+    BlockTimer::State getBlockTimerState () const;
+
+    // looked up once; finding them by ID allocates
+    std::array<std::atomic<float>*, 8> blockTimerParameters {};
+   #endif
+
+    // host state; the blob is rebuilt only after a parameter or the preset name changed
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+
+    std::array<juce::RangedAudioParameter*, PluginState::numParameters> stateParameters {};
+    std::atomic<bool> stateDirty { true };
+    juce::CriticalSection stateLock;
+    juce::MemoryBlock cachedState;
+    juce::String cachedPresetName;
+
+    // published once per block
+    TripleBuffer<TelemetrySnapshot> telemetry;
+    juce::uint64 telemetryBlocks = 0;
+    std::atomic<bool> dynamicsMetering { false };
+
+    SpectrumAnalyzer analyzer;
+
+    template <typename SampleType>
+    void publishTelemetry (const juce::AudioBuffer<SampleType>& buffer, const DynamicsProcessorBase::Meters& dynamics);
+
+    // skips the whole chain once input and tails are silent
+    SilenceGate silenceGate;
+
+    // reported to the host; recomputed when the mapped parameters move
+    std::atomic<double> tailSeconds { 0.0 };
+    juce::uint32 tailGeneration = 0;
+
+    void updateTailLength (const ToneEngine::EngineParameters& params);
+
+    // only the precision the host picked is prepared
+    BasicModeProcessor<double> modeProcessorDouble;
+    juce::dsp::Gain<double> inputGainDouble, outputGainDouble;
+
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer,
+                         BasicModeProcessor<SampleType>& chain,
+                         juce::dsp::Gain<SampleType>& inGain,
+                         juce::dsp::Gain<SampleType>& outGain,
+                         SoftBypass<SampleType>& bypass);
+
+    // last tempo reported by the host playhead
+    double hostBpm = 120.0;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StringSauceAudioProcessor)
 };
@@ -0,0 +1,146 @@
+//
+//  PluginState.cpp
+//  StringSauce
+//
+//  Implementation of the plugin state format
+
+#include "PluginState.hpp"
+
+namespace
+{
+    // what copyXmlToBinary puts in front of the text
+    constexpr juce::uint32 xmlMagic = 0x21324356;
+
+    bool isSpace(char c) noexcept { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    std::string_view tagName(std::string_view text, size_t start)
+    {
+        size_t end = start;
+        while (end < text.size() && ! isSpace(text[end]) && text[end] != '>' && text[end] != '/')
+            ++end;
+
+        return text.substr(start, end - start);
+    }
+
+    // value of name="..." (or '...') inside one tag; empty when missing
+    std::string_view attribute(std::string_view tag, std::string_view name)
+    {
+        for (size_t pos = tag.find(name); pos != std::string_view::npos; pos = tag.find(name, pos + 1))
+        {
+            const auto after = pos + name.size();
+
+            if (pos == 0 || ! isSpace(tag[pos - 1])) continue;
+            if (after + 1 >= tag.size() || tag[after] != '=') continue;
+
+            const char quote = tag[after + 1];
+            if (quote != '"' && quote != '\'') continue;
+
+            const auto close = tag.find(quote, after + 2);
+            if (close == std::string_view::npos) return {};
+
+            return tag.substr(after + 2, close - after - 2);
+        }
+
+        return {};
+    }
+}
+
+void PluginState::write(const Contents& contents, juce::MemoryBlock& dest)
+{
+    dest.reset();
+    juce::MemoryOutputStream out(dest, false);
+
+    out.writeInt((int) magic);
+    out.writeShort((short) version);
+    out.writeShort((short) numParameters);
+
+    for (auto v : contents.values)
+        out.writeFloat(v);
+
+    out.writeString(contents.presetName);
+}
+
+bool PluginState::read(const void* data, int sizeInBytes, const juce::String& xmlRootTag, Contents& result)
+{
+    if (data == nullptr || sizeInBytes < 8) return false;
+
+    const auto header = juce::ByteOrder::littleEndianInt(data);
+
+    if (header == magic)    return readBinary(data, sizeInBytes, result);
+    if (header == xmlMagic) return readXml(data, sizeInBytes, xmlRootTag, result);
+
+    return false;
+}
+
+bool PluginState::readBinary(const void* data, int sizeInBytes, Contents& result)
+{
+    juce::MemoryInputStream in(data, (size_t) sizeInBytes, false);
+
+    in.readInt();
+    in.readShort();   // version; nothing depends on it yet
+
+    const auto stored = (size_t) (juce::uint16) in.readShort();
+    if (in.getNumBytesRemaining() < (juce::int64) (stored * sizeof(float))) return false;
+
+    for (size_t i = 0; i < stored; ++i)
+    {
+        const float v = in.readFloat();
+
+        // values from newer versions that this one doesn't know are skipped
+        if (i < numParameters)
+        {
+            result.values[i]  = v;
+            result.present[i] = true;
+        }
+    }
+
+    result.presetName = in.readString();
+    return true;
+}
+
+bool PluginState::readXml(const void* data, int sizeInBytes, const juce::String& xmlRootTag, Contents& result)
+{
+    // scanned in place rather than parsed into an XmlElement and a ValueTree
+    const auto* bytes  = static_cast<const char*>(data);
+    const auto length  = juce::jmin((size_t) juce::ByteOrder::littleEndianInt(bytes + 4), (size_t) sizeInBytes - 8);
+    const std::string_view text(bytes + 8, length);
+
+    // the first element, past the declaration and any comments, has to be the APVTS root
+    size_t pos = 0;
+
+    for (;;)
+    {
+        pos = text.find('<', pos);
+        if (pos == std::string_view::npos || pos + 1 >= text.size()) return false;
+
+        if (text[pos + 1] != '?' && text[pos + 1] != '!') break;
+        ++pos;
+    }
+
+    if (tagName(text, pos + 1) != std::string_view(xmlRootTag.toRawUTF8())) return false;
+
+    for (pos = text.find("<PARAM", pos); pos != std::string_view::npos; pos = text.find("<PARAM", pos + 1))
+    {
+        if (tagName(text, pos + 1) != "PARAM") continue;
+
+        const auto end = text.find('>', pos);
+        if (end == std::string_view::npos) break;
+
+        const auto tag   = text.substr(pos, end - pos);
+        const auto id    = attribute(tag, "id");
+        const auto value = attribute(tag, "value");
+
+        if (id.empty() || value.empty()) continue;
+
+        for (size_t i = 0; i < numParameters; ++i)
+        {
+            if (id != parameterIds[i]) continue;
+
+            result.values[i]  = juce::String::fromUTF8(value.data(), (int) value.size()).getFloatValue();
+            result.present[i] = true;
+            break;
+        }
+    }
+
+    return true;
+}
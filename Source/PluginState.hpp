@@ -0,0 +1,56 @@
+//
+//  PluginState.hpp
+//  StringSauce
+//
+//  The host-saved plugin state as a small fixed-layout blob:
+//
+//      uint32   magic 'SSST'
+//      uint16   version
+//      uint16   number of values
+//      float32  plain parameter values, in parameterIds order
+//      UTF-8    preset name, null-terminated
+//
+//  All little-endian. New parameters go on the end of
+//  parameterIds and later versions may append after the name,
+//  so older readers still load what they know. Blobs from
+//  before this format (APVTS XML via copyXmlToBinary) are read
+//  too, by scanning the text for PARAM elements.
+
+#ifndef PluginState_hpp
+#define PluginState_hpp
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterID.hpp"
+
+class PluginState
+{
+public:
+    static constexpr juce::uint32 magic   = 0x54535353;   // "SSST" in file order
+    static constexpr juce::uint16 version = 1;
+
+    static constexpr std::array<const char*, 9> parameterIds {
+        ParamID::CHARACTER, ParamID::THUMP, ParamID::BODY, ParamID::SHIMMER, ParamID::SPANK,
+        ParamID::SPACE, ParamID::MODE, ParamID::SYNC, ParamID::BYPASS
+    };
+
+    static constexpr size_t numParameters = parameterIds.size();
+
+    struct Contents
+    {
+        std::array<float, numParameters> values {};   // plain values
+        std::array<bool, numParameters> present {};   // false where the blob had none
+        juce::String presetName;                      // empty for the XML format
+    };
+
+    static void write(const Contents& contents, juce::MemoryBlock& dest);
+
+    // either format; xmlRootTag is the APVTS state type the XML must carry
+    static bool read(const void* data, int sizeInBytes, const juce::String& xmlRootTag, Contents& result);
+
+private:
+    static bool readBinary(const void* data, int sizeInBytes, Contents& result);
+    static bool readXml(const void* data, int sizeInBytes, const juce::String& xmlRootTag, Contents& result);
+};
+
+#endif
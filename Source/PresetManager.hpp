@@ -6,21 +6,19 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include "ParameterID.hpp"
 
 class PresetManager : private juce::ValueTree::Listener
 {
 public:
     static constexpr const char* presetExtension = "stringsauce";
 
+    // no file-system work here; hosts construct the processor for every scan and project load
     PresetManager(juce::AudioProcessorValueTreeState& stateToUse, const juce::String& pluginName) :
           apvts(stateToUse),
-          pluginName(pluginName),
-          presetDir(makePresetDirectory(pluginName))
+          pluginName(pluginName)
     {
-        if (!presetDir.exists()) presetDir.createDirectory();
-
         apvts.state.addListener(this);
-        reloadUserPresetList();
     }
 
     struct FactoryPreset
@@ -34,57 +32,79 @@ public:
         return factoryPresets;
     }
 
-    // Create APVTS state
-    juce::ValueTree makeFactoryPresetState(
-        std::initializer_list<std::pair<const char*, float>> values)
+    // Create APVTS state from (parameter ID, normalised value) pairs.
+    // Built directly in the layout replaceState expects, with defaults for anything
+    // the preset leaves out; the live parameters and state are never touched.
+    template <typename Values>
+    juce::ValueTree makeFactoryPresetState(const Values& values) const
     {
-        suppressDirtyFlag = true;
+        for (auto& pair : values)
+            if (apvts.getParameter(pair.first) == nullptr)
+                DBG("PresetManager: Missing parameter ID in factory preset -> " << pair.first);
 
-        auto backup = apvts.copyState();
+        juce::ValueTree presetState(apvts.state.getType());
 
-        // Apply parameter values
-        for (auto& pair : values)
+        for (auto* p : apvts.processor.getParameters())
         {
-            auto* param = apvts.getParameter(pair.first);
-
-            if (param != nullptr)
-            {
-                param->beginChangeGesture();
-                param->setValueNotifyingHost(pair.second);
-                param->endChangeGesture();
-            }
-            else
-            {
-                DBG("PresetManager: Missing parameter ID in factory preset -> " << pair.first);
-            }
-        }
+            auto* param = dynamic_cast<juce::RangedAudioParameter*>(p);
+            if (param == nullptr || !isPresetParameter(param->getParameterID())) continue;
 
-        auto presetState = apvts.copyState();
-        apvts.replaceState(backup);
+            float normalised = param->getDefaultValue();
+
+            for (auto& pair : values)
+                if (param->getParameterID() == pair.first)
+                    normalised = pair.second;
+
+            presetState.appendChild(juce::ValueTree("PARAM", { { "id",    param->getParameterID() },
+                                                               { "value", param->convertFrom0to1(normalised) } }),
+                                    nullptr);
+        }
 
-        suppressDirtyFlag = false;
         return presetState;
     }
 
-    void addFactoryPreset(const juce::String& name, std::initializer_list<std::pair<const char*, float>> values)
+    template <typename Values>
+    void addFactoryPreset(const juce::String& name, const Values& values)
     {
         factoryPresets.push_back({ name, makeFactoryPresetState(values) });
     }
 
+    void addFactoryPreset(const juce::String& name, std::initializer_list<std::pair<const char*, float>> values)
+    {
+        addFactoryPreset<decltype(values)>(name, values);
+    }
+
     // USER PRESETS
+    // created on first use, which is the preset UI
+    const juce::File& getPresetDirectory()
+    {
+        if (presetDir == juce::File())
+        {
+            presetDir = makePresetDirectory(pluginName);
+            if (!presetDir.exists()) presetDir.createDirectory();
+        }
+
+        return presetDir;
+    }
+
     void reloadUserPresetList()
     {
         userFiles.clear();
 
         juce::Array<juce::File> found;
-        presetDir.findChildFiles(found, juce::File::findFiles, false, "*." + juce::String(presetExtension));
+        getPresetDirectory().findChildFiles(found, juce::File::findFiles, false, "*." + juce::String(presetExtension));
 
         for (auto& f : found)
             userFiles.push_back(f);
+
+        userFilesScanned = true;
     }
 
-    const std::vector<juce::File>& getUserPresetFiles() const
+    // scanned the first time they are asked for
+    const std::vector<juce::File>& getUserPresetFiles()
     {
+        if (!userFilesScanned) reloadUserPresetList();
+
         return userFiles;
     }
 
@@ -112,6 +132,9 @@ public:
         auto vt = juce::ValueTree::fromXml(*xml);
         if (!vt.isValid()) return false;
 
+        // presets saved before bypass was excluded still carry it
+        stripHostParameters(vt);
+
         suppressDirtyFlag = true;
         apvts.replaceState(vt);
         suppressDirtyFlag = false;
@@ -128,7 +151,7 @@ public:
 
         suppressDirtyFlag = true;
 
-        auto file = presetDir.getChildFile(currentPresetName + "." + presetExtension);
+        auto file = getPresetDirectory().getChildFile(currentPresetName + "." + presetExtension);
 
         bool ok = writePreset(file);
 
@@ -158,7 +181,7 @@ public:
     // Delete preset by name
     bool deletePreset(const juce::String& name)
     {
-        auto file = presetDir.getChildFile(name + "." + presetExtension);
+        auto file = getPresetDirectory().getChildFile(name + "." + presetExtension);
 
         if (file.existsAsFile()) return file.deleteFile();
 
@@ -166,6 +189,9 @@ public:
     }
 
     const juce::String& getCurrentPresetName() const { return currentPresetName; }
+
+    // restored with the host's saved state
+    void setCurrentPresetName(const juce::String& name) { currentPresetName = name; }
     bool isCurrentPresetDirty() const { return isDirty; }
 
 private:
@@ -176,6 +202,7 @@ private:
 
     std::vector<FactoryPreset> factoryPresets;
     std::vector<juce::File> userFiles;
+    bool userFilesScanned = false;
 
     juce::String currentPresetName = "Unsaved Preset";
     bool isDirty = false;
@@ -183,6 +210,20 @@ private:
     std::atomic<bool> suppressDirtyFlag { false };
 
     // Helpers
+    // bypass belongs to the host session, not the sound; replaceState keeps the
+    // current value of any parameter the preset tree leaves out
+    static bool isPresetParameter(const juce::String& paramID)
+    {
+        return paramID != ParamID::BYPASS;
+    }
+
+    static void stripHostParameters(juce::ValueTree& state)
+    {
+        for (int i = state.getNumChildren(); --i >= 0;)
+            if (!isPresetParameter(state.getChild(i).getProperty("id").toString()))
+                state.removeChild(i, nullptr);
+    }
+
     static juce::File makePresetDirectory(const juce::String& pluginName)
     {
         auto docs = juce::File::getSpecialLocation(
@@ -193,14 +234,19 @@ private:
 
     bool writePreset(const juce::File& file)
     {
-        if (auto xml = apvts.copyState().createXml()) return xml->writeTo(file);
+        auto state = apvts.copyState();
+        stripHostParameters(state);
+
+        if (auto xml = state.createXml()) return xml->writeTo(file);
 
         return false;
     }
 
     // Dirty tracking
-    void valueTreePropertyChanged(juce::ValueTree&, const juce::Identifier&) override
+    void valueTreePropertyChanged(juce::ValueTree& tree, const juce::Identifier&) override
     {
+        if (!isPresetParameter(tree.getProperty("id").toString())) return;
+
         if (!suppressDirtyFlag) isDirty = true;
     }
 
@@ -0,0 +1,354 @@
+//
+//  RealtimeGuard.cpp
+//  StringSauce
+//
+//  Implementation of the realtime-safety guard and its hooks
+
+#include "RealtimeGuard.hpp"
+
+#if STRINGSAUCE_RT_GUARD
+
+#include <new>
+#include <cstdlib>
+
+#if ! JUCE_WINDOWS
+ #include <execinfo.h>
+ #include <dlfcn.h>
+ #include <cxxabi.h>
+#endif
+
+#define STRINGSAUCE_RT_GUARD_GLIBC (STRINGSAUCE_RT_GUARD_INTERPOSE && JUCE_LINUX && defined (__GLIBC__))
+
+#if STRINGSAUCE_RT_GUARD_GLIBC
+ #include <pthread.h>
+
+extern "C"
+{
+    void* __libc_malloc(size_t) noexcept;
+    void* __libc_calloc(size_t, size_t) noexcept;
+    void* __libc_realloc(void*, size_t) noexcept;
+    void  __libc_free(void*) noexcept;
+}
+#endif
+
+namespace
+{
+    // realtime scopes open on this thread, and whether a violation is being recorded
+    thread_local int realtimeDepth = 0;
+    thread_local bool recording    = false;
+
+    // one slot of the violation history; sequence is odd while the slot is written
+    struct Record
+    {
+        std::atomic<juce::uint32> sequence { 0 };
+        RealtimeGuard::Kind kind = RealtimeGuard::Kind::allocation;
+        size_t bytes  = 0;
+        int numFrames = 0;
+        void* frames[RealtimeGuard::maxFrames] {};
+    };
+
+    std::atomic<juce::uint64> counts[3] {};
+    Record records[RealtimeGuard::historySize];
+    std::atomic<juce::uint32> nextRecord { 0 };
+
+    int captureFrames(void** frames, int maxNumber) noexcept
+    {
+       #if JUCE_WINDOWS
+        return (int) CaptureStackBackTrace(0, (DWORD) maxNumber, frames, nullptr);
+       #else
+        return backtrace(frames, maxNumber);
+       #endif
+    }
+
+    // glibc loads its unwinder on the first backtrace(), which allocates; get that done at load time
+    struct WarmUp
+    {
+        WarmUp() noexcept
+        {
+            void* frames[2];
+            captureFrames(frames, 2);
+        }
+    } warmUp;
+
+    juce::String describeFrame(void* address)
+    {
+       #if JUCE_WINDOWS
+        return "0x" + juce::String::toHexString((juce::pointer_sized_int) address);
+       #else
+        Dl_info info {};
+
+        if (dladdr(address, &info) == 0 || info.dli_fname == nullptr)
+            return "0x" + juce::String::toHexString((juce::pointer_sized_int) address);
+
+        const auto module = juce::File(info.dli_fname).getFileName();
+
+        // unexported symbols resolve to the module only; addr2line takes the offset
+        if (info.dli_sname == nullptr)
+            return module + " + 0x" + juce::String::toHexString((juce::pointer_sized_int) address
+                                                                - (juce::pointer_sized_int) info.dli_fbase);
+
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        const juce::String name (status == 0 && demangled != nullptr ? demangled : info.dli_sname);
+        std::free(demangled);
+
+        return name + " + 0x" + juce::String::toHexString((juce::pointer_sized_int) address
+                                                          - (juce::pointer_sized_int) info.dli_saddr)
+             + " (" + module + ")";
+       #endif
+    }
+
+    // the guard's own frames and the hooked function itself are noise at the top of a call site
+    bool isGuardFrame(const juce::String& frame)
+    {
+        for (auto* name : { "RealtimeGuard", "operator new", "operator delete", "malloc", "calloc",
+                            "realloc", "free", "pthread_mutex_lock", "captureFrames" })
+            if (frame.startsWith(name))
+                return true;
+
+        return false;
+    }
+
+    void* rawAllocate(size_t size) noexcept
+    {
+       #if STRINGSAUCE_RT_GUARD_GLIBC
+        return __libc_malloc(size);
+       #else
+        return std::malloc(size);
+       #endif
+    }
+
+    void rawFree(void* p) noexcept
+    {
+       #if STRINGSAUCE_RT_GUARD_GLIBC
+        __libc_free(p);
+       #else
+        std::free(p);
+       #endif
+    }
+
+    void* allocate(size_t size) noexcept
+    {
+        RealtimeGuard::note(RealtimeGuard::Kind::allocation, size);
+        return rawAllocate(size == 0 ? 1 : size);
+    }
+
+    void* allocateAligned(size_t size, std::align_val_t alignment) noexcept
+    {
+        RealtimeGuard::note(RealtimeGuard::Kind::allocation, size);
+
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size == 0 ? 1 : size, (size_t) alignment);
+       #else
+        void* p = nullptr;
+        const auto a = juce::jmax((size_t) alignment, sizeof(void*));
+        return posix_memalign(&p, a, size == 0 ? 1 : size) == 0 ? p : nullptr;
+       #endif
+    }
+
+    void release(void* p) noexcept
+    {
+        if (p == nullptr) return;
+
+        RealtimeGuard::note(RealtimeGuard::Kind::deallocation, 0);
+        rawFree(p);
+    }
+
+    void releaseAligned(void* p) noexcept
+    {
+        if (p == nullptr) return;
+
+        RealtimeGuard::note(RealtimeGuard::Kind::deallocation, 0);
+
+       #if JUCE_WINDOWS
+        _aligned_free(p);
+       #else
+        rawFree(p);
+       #endif
+    }
+
+    template <typename Fn>
+    void* allocateOrThrow(Fn&& fn)
+    {
+        if (auto* p = fn())
+            return p;
+
+        throw std::bad_alloc();
+    }
+}
+
+//==============================================================================
+RealtimeGuard::ScopedRealtime::ScopedRealtime(bool isActive) noexcept : active(isActive) { if (active) ++realtimeDepth; }
+RealtimeGuard::ScopedRealtime::~ScopedRealtime()                                        { if (active) --realtimeDepth; }
+
+void RealtimeGuard::note(Kind kind, size_t bytes) noexcept
+{
+    if (realtimeDepth == 0 || recording) return;
+
+    // anything the recording itself calls is not counted
+    recording = true;
+
+    counts[(int) kind].fetch_add(1, std::memory_order_relaxed);
+
+    auto& r = records[nextRecord.fetch_add(1, std::memory_order_relaxed) % (juce::uint32) historySize];
+    const auto sequence = r.sequence.load(std::memory_order_relaxed);
+
+    r.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    r.kind      = kind;
+    r.bytes     = bytes;
+    r.numFrames = captureFrames(r.frames, maxFrames);
+
+    r.sequence.store(sequence + 2, std::memory_order_release);
+
+    recording = false;
+}
+
+RealtimeGuard::Counts RealtimeGuard::getCounts() noexcept
+{
+    Counts c;
+    c.allocations   = counts[(int) Kind::allocation].load(std::memory_order_relaxed);
+    c.deallocations = counts[(int) Kind::deallocation].load(std::memory_order_relaxed);
+    c.locks         = counts[(int) Kind::lock].load(std::memory_order_relaxed);
+    return c;
+}
+
+std::vector<RealtimeGuard::Violation> RealtimeGuard::getRecentViolations(int maxNumber)
+{
+    std::vector<Violation> result;
+
+    const auto written = nextRecord.load(std::memory_order_relaxed);
+    const auto count   = juce::jmin(written, (juce::uint32) historySize, (juce::uint32) juce::jmax(0, maxNumber));
+
+    for (juce::uint32 i = 0; i < count; ++i)
+    {
+        auto& r = records[(written - 1 - i) % (juce::uint32) historySize];
+
+        // copy out, and drop the slot if a writer was in it meanwhile
+        const auto before = r.sequence.load(std::memory_order_acquire);
+        if ((before & 1) != 0) continue;
+
+        Record copy;
+        copy.kind      = r.kind;
+        copy.bytes     = r.bytes;
+        copy.numFrames = juce::jlimit(0, maxFrames, r.numFrames);
+        std::copy(r.frames, r.frames + copy.numFrames, copy.frames);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (r.sequence.load(std::memory_order_relaxed) != before) continue;
+
+        juce::StringArray frames;
+        for (int f = 0; f < copy.numFrames; ++f)
+            frames.add(describeFrame(copy.frames[f]));
+
+        // the call site starts after the last hook frame near the top; unexported helpers sit between them
+        int first = 0;
+        for (int f = 0; f < juce::jmin(6, frames.size()); ++f)
+            if (isGuardFrame(frames[f]))
+                first = f + 1;
+
+        Violation v { copy.kind, copy.bytes, {} };
+        for (int f = first; f < frames.size(); ++f)
+            v.callSite.add(frames[f]);
+
+        result.push_back(std::move(v));
+    }
+
+    return result;
+}
+
+const char* RealtimeGuard::getKindName(Kind kind) noexcept
+{
+    switch (kind)
+    {
+        case Kind::allocation:   return "allocation";
+        case Kind::deallocation: return "deallocation";
+        case Kind::lock:         return "lock";
+    }
+
+    return "";
+}
+
+//==============================================================================
+// replaced global allocation functions; counted only inside a realtime scope
+
+void* operator new  (std::size_t n)                                    { return allocateOrThrow([n] { return allocate(n); }); }
+void* operator new[](std::size_t n)                                    { return allocateOrThrow([n] { return allocate(n); }); }
+void* operator new  (std::size_t n, const std::nothrow_t&) noexcept    { return allocate(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept    { return allocate(n); }
+void* operator new  (std::size_t n, std::align_val_t a)                { return allocateOrThrow([n, a] { return allocateAligned(n, a); }); }
+void* operator new[](std::size_t n, std::align_val_t a)                { return allocateOrThrow([n, a] { return allocateAligned(n, a); }); }
+void* operator new  (std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return allocateAligned(n, a); }
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return allocateAligned(n, a); }
+
+void operator delete  (void* p) noexcept                                  { release(p); }
+void operator delete[](void* p) noexcept                                  { release(p); }
+void operator delete  (void* p, std::size_t) noexcept                     { release(p); }
+void operator delete[](void* p, std::size_t) noexcept                     { release(p); }
+void operator delete  (void* p, const std::nothrow_t&) noexcept           { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept           { release(p); }
+void operator delete  (void* p, std::align_val_t) noexcept                { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept                { releaseAligned(p); }
+void operator delete  (void* p, std::size_t, std::align_val_t) noexcept   { releaseAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept   { releaseAligned(p); }
+void operator delete  (void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(p); }
+
+#if STRINGSAUCE_RT_GUARD_GLIBC
+//==============================================================================
+// C allocations and mutex locks, interposed for the whole process
+
+namespace
+{
+    using LockFn = int (*)(pthread_mutex_t*);
+    std::atomic<LockFn> realMutexLock { nullptr };
+}
+
+extern "C"
+{
+    void* malloc(size_t n) noexcept
+    {
+        RealtimeGuard::note(RealtimeGuard::Kind::allocation, n);
+        return __libc_malloc(n);
+    }
+
+    void* calloc(size_t n, size_t size) noexcept
+    {
+        RealtimeGuard::note(RealtimeGuard::Kind::allocation, n * size);
+        return __libc_calloc(n, size);
+    }
+
+    void* realloc(void* p, size_t n) noexcept
+    {
+        RealtimeGuard::note(RealtimeGuard::Kind::allocation, n);
+        return __libc_realloc(p, n);
+    }
+
+    void free(void* p) noexcept
+    {
+        if (p != nullptr)
+            RealtimeGuard::note(RealtimeGuard::Kind::deallocation, 0);
+
+        __libc_free(p);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+    {
+        RealtimeGuard::note(RealtimeGuard::Kind::lock, 0);
+
+        // ld.so's own locks don't come through here, so resolving the real one can't recurse
+        auto fn = realMutexLock.load(std::memory_order_acquire);
+
+        if (fn == nullptr)
+        {
+            fn = reinterpret_cast<LockFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+            realMutexLock.store(fn, std::memory_order_release);
+        }
+
+        return fn(mutex);
+    }
+}
+#endif
+
+#endif
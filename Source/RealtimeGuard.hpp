@@ -0,0 +1,95 @@
+//
+//  RealtimeGuard.hpp
+//  StringSauce
+//
+//  Flags allocations and blocking locks made on the audio thread.
+//  A scope marks the current thread as realtime; the replaced
+//  global operator new/delete (and, where interposition is
+//  enabled, malloc and pthread_mutex_lock) count anything called
+//  inside it and keep the call sites of the most recent ones.
+//  Compiles out unless STRINGSAUCE_RT_GUARD is set; it defaults
+//  to on in debug builds.
+
+#ifndef RealtimeGuard_hpp
+#define RealtimeGuard_hpp
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef STRINGSAUCE_RT_GUARD
+ #if JUCE_DEBUG
+  #define STRINGSAUCE_RT_GUARD 1
+ #else
+  #define STRINGSAUCE_RT_GUARD 0
+ #endif
+#endif
+
+// also intercept malloc/free and pthread_mutex_lock; glibc only, and process-wide,
+// so only the console targets turn it on
+#ifndef STRINGSAUCE_RT_GUARD_INTERPOSE
+ #define STRINGSAUCE_RT_GUARD_INTERPOSE 0
+#endif
+
+#if STRINGSAUCE_RT_GUARD
+
+class RealtimeGuard
+{
+public:
+    enum class Kind { allocation, deallocation, lock };
+
+    struct Counts
+    {
+        juce::uint64 allocations   = 0;
+        juce::uint64 deallocations = 0;
+        juce::uint64 locks         = 0;
+
+        juce::uint64 total() const noexcept { return allocations + deallocations + locks; }
+    };
+
+    struct Violation
+    {
+        Kind kind;
+        size_t bytes = 0;
+        juce::StringArray callSite;   // innermost frame first
+    };
+
+    // marks the calling thread as realtime for its lifetime, unless isActive is false; nests
+    struct ScopedRealtime
+    {
+        explicit ScopedRealtime(bool isActive = true) noexcept;
+        ~ScopedRealtime();
+
+    private:
+        const bool active;
+    };
+
+    // any thread
+    static Counts getCounts() noexcept;
+
+    // message thread: the newest violations first, symbolised; allocates
+    static std::vector<Violation> getRecentViolations(int maxNumber = 8);
+
+    static const char* getKindName(Kind kind) noexcept;
+
+    // called by the hooks; cheap when the thread is not realtime
+    static void note(Kind kind, size_t bytes) noexcept;
+
+    static constexpr int historySize = 32;
+    static constexpr int maxFrames   = 12;
+};
+
+ #define STRINGSAUCE_REALTIME_SCOPE \
+    RealtimeGuard::ScopedRealtime JUCE_JOIN_MACRO(realtimeScope_, __LINE__)
+
+ // for code that is also timed: guard an untimed pass, leave the timed one alone
+ #define STRINGSAUCE_REALTIME_SCOPE_IF(condition) \
+    RealtimeGuard::ScopedRealtime JUCE_JOIN_MACRO(realtimeScope_, __LINE__) (condition)
+
+#else
+
+ #define STRINGSAUCE_REALTIME_SCOPE
+ #define STRINGSAUCE_REALTIME_SCOPE_IF(condition)
+
+#endif
+
+#endif
@@ -9,26 +9,43 @@
 namespace
 {
     // waveshaping curves
-    float tapeShape(float x)        { return std::tanh(0.9f * x) * 0.8f; }
-    float tubeShape(float x)        { return std::tanh(1.5f * x - 0.2f * x * x * x); }
-    float transistorShape(float x)  { return std::tanh(2.5f * x) + 0.05f * std::sin(6.0f * x); }
-    float exciterShape(float x)     { return 0.6f * std::sin(x * 2.0f) + 0.4f * x; }
+    template <typename T> T tapeShape(T x)        { return std::tanh(T(0.9) * x) * T(0.8); }
+    template <typename T> T tubeShape(T x)        { return std::tanh(T(1.5) * x - T(0.2) * x * x * x); }
+    template <typename T> T transistorShape(T x)  { return std::tanh(T(2.5) * x) + T(0.05) * std::sin(T(6) * x); }
+    template <typename T> T exciterShape(T x)     { return T(0.6) * std::sin(x * T(2)) + T(0.4) * x; }
 }
 
-SaturationProcessor::SaturationProcessor()
+template <typename SampleType>
+BasicSaturationProcessor<SampleType>::BasicSaturationProcessor()
 {
     currentType = Type::Tape;
 }
 
-void SaturationProcessor::prepare(const juce::dsp::ProcessSpec& spec)
+template <typename SampleType>
+void BasicSaturationProcessor<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
 {
     sampleRate = spec.sampleRate;
-    oversampler = std::make_unique<juce::dsp::Oversampling<float>>(spec.numChannels, 2, juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR);
+    oversampler = std::make_unique<juce::dsp::Oversampling<SampleType>>(spec.numChannels, 2, juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR);
+    oversampler->initProcessing(spec.maximumBlockSize);
+    oversampledRate = sampleRate * (double) oversampler->getOversamplingFactor();
+
+    // one tone filter per channel, at the rate it actually runs at
+    toneFilter.prepare({ oversampledRate,
+                         (juce::uint32) (spec.maximumBlockSize * oversampler->getOversamplingFactor()),
+                         spec.numChannels });
     shaper.reset();
     toneFilter.reset();
     dryWet.reset();
     dryWet.prepare(spec);
     dryWet.setMixingRule(juce::dsp::DryWetMixingRule::linear);
+
+    // a whole-sample latency the host can compensate, the same with or without drive
+    oversamplerLatency = oversampler->getLatencyInSamples();
+    latencySamples     = (int) std::ceil(oversamplerLatency);
+    latencyPad.prepare(spec);
+
+    // line the dry path up with the oversampled wet path so partial mixes don't comb
+    dryWet.setWetLatency((SampleType) latencySamples);
     dryWet.setWetMixProportion(params.mix);
     updateWaveshaper();
     updateToneFilter();
@@ -36,15 +53,18 @@ void SaturationProcessor::prepare(const juce::dsp::ProcessSpec& spec)
     oversampler->reset();
 }
 
-void SaturationProcessor::reset()
+template <typename SampleType>
+void BasicSaturationProcessor<SampleType>::reset()
 {
     shaper.reset();
     toneFilter.reset();
     dryWet.reset();
+    latencyPad.reset();
     if (oversampler) oversampler->reset();
 }
 
-void SaturationProcessor::setParameters(const SaturationParameters& newParams)
+template <typename SampleType>
+void BasicSaturationProcessor<SampleType>::setParameters(const SaturationParameters& newParams)
 {
     params = newParams;
 
@@ -59,7 +79,8 @@ void SaturationProcessor::setParameters(const SaturationParameters& newParams)
     dryWet.setWetMixProportion(params.mix);
 }
 
-void SaturationProcessor::setType(Type newType)
+template <typename SampleType>
+void BasicSaturationProcessor<SampleType>::setType(Type newType)
 {
     if (currentType != newType)
     {
@@ -68,41 +89,53 @@ void SaturationProcessor::setType(Type newType)
     }
 }
 
-void SaturationProcessor::updateDrive()
+template <typename SampleType>
+void BasicSaturationProcessor<SampleType>::updateDrive()
 {
     driveGain = juce::Decibels::decibelsToGain(params.drive * 18.0f);
 }
 
-void SaturationProcessor::updateToneFilter()
+template <typename SampleType>
+void BasicSaturationProcessor<SampleType>::updateToneFilter()
 {
-    auto coeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-                                                                     sampleRate,
-                                                                     juce::jmap(params.tone, 2000.0f, 8000.0f),
-                                                                     0.707f,
-                                                                     juce::jmap(params.tone,0.5f, 2.0f)
+    // written in place, no allocation
+    *toneFilter.state = juce::dsp::IIR::ArrayCoefficients<SampleType>::makeHighShelf(
+                                                                     oversampledRate,
+                                                                     (SampleType) juce::jmap(params.tone, 2000.0f, 8000.0f),
+                                                                     (SampleType) 0.707,
+                                                                     (SampleType) juce::jmap(params.tone, 0.5f, 2.0f)
     );
-
-    toneFilter.coefficients = coeffs;
 }
 
-void SaturationProcessor::updateWaveshaper()
+template <typename SampleType>
+void BasicSaturationProcessor<SampleType>::updateWaveshaper()
 {
     switch (currentType)
     {
-        case Type::Tape:        shaper.functionToUse = tapeShape;       break;
-        case Type::Tube:        shaper.functionToUse = tubeShape;       break;
-        case Type::Transistor:  shaper.functionToUse = transistorShape; break;
-        case Type::Exciter:     shaper.functionToUse = exciterShape;    break;
+        case Type::Tape:        shaper.functionToUse = tapeShape<SampleType>;       break;
+        case Type::Tube:        shaper.functionToUse = tubeShape<SampleType>;       break;
+        case Type::Transistor:  shaper.functionToUse = transistorShape<SampleType>; break;
+        case Type::Exciter:     shaper.functionToUse = exciterShape<SampleType>;    break;
     }
 }
 
-void SaturationProcessor::process(const juce::dsp::ProcessContextReplacing<float>& context)
+template <typename SampleType>
+void BasicSaturationProcessor<SampleType>::process(const juce::dsp::ProcessContextReplacing<SampleType>& context)
 {
     if (!oversampler) return;
     
     const auto& p = params;
 
-    if (p.mix <= 0.0001f || p.drive <= 0.0001f) return;
+    if (p.mix <= 0.0001f || p.drive <= 0.0001f)
+    {
+        // idle, but still as late as when driving
+        if (latencySamples > 0)
+        {
+            latencyPad.setDelay((SampleType) latencySamples);
+            latencyPad.process(context);
+        }
+        return;
+    }
 
 
     auto& output = context.getOutputBlock();
@@ -112,39 +145,38 @@ void SaturationProcessor::process(const juce::dsp::ProcessContextReplacing<float
 
     dryWet.pushDrySamples(output);
 
-    // oversample
+    // oversample; the returned block has every prepared channel, so keep only the ones passed in
     auto oversampledBlock = oversampler->processSamplesUp(output);
-    auto osBlock = oversampledBlock;
+    auto osBlock = oversampledBlock.getSubsetChannelBlock(0, juce::jmin(numCh, oversampledBlock.getNumChannels()));
 
     // apply drive
     for (size_t ch = 0; ch < osBlock.getNumChannels(); ++ch)
     {
         if (auto* data = osBlock.getChannelPointer(ch))
         {
-            for (size_t i = 0; i < osBlock.getNumSamples(); ++i) data[i] = (data[i] + params.bias) * driveGain;
+            for (size_t i = 0; i < osBlock.getNumSamples(); ++i) data[i] = (data[i] + (SampleType) params.bias) * (SampleType) driveGain;
         }
     }
 
     // waveshaper
-    shaper.process(juce::dsp::ProcessContextReplacing<float>(osBlock));
+    shaper.process(juce::dsp::ProcessContextReplacing<SampleType>(osBlock));
 
-    // tone filter
-    for (size_t ch = 0; ch < osBlock.getNumChannels(); ++ch)
-    {
-        if (auto* data = osBlock.getChannelPointer(ch))
-        {
-            juce::dsp::AudioBlock<float> chBlock(&data, 1, osBlock.getNumSamples());
-            juce::dsp::ProcessContextReplacing<float> ctx(chBlock);
-            toneFilter.process(ctx);
-        }
-    }
+    // tone filter, each channel through its own state
+    toneFilter.process(juce::dsp::ProcessContextReplacing<SampleType>(osBlock));
 
     // downsample
     oversampler->processSamplesDown(output);
 
+    const auto padding = (SampleType) latencySamples - oversamplerLatency;
+    if (padding > (SampleType) 0.0001)
+    {
+        latencyPad.setDelay(padding);
+        latencyPad.process(context);
+    }
+
     // output compensation
     const float driveCompensity = 0.6f;
-    const float comp = 1.0f / juce::jmax(1.0f, driveGain * driveCompensity);
+    const auto comp = (SampleType) (1.0f / juce::jmax(1.0f, driveGain * driveCompensity));
 
     for (size_t ch = 0; ch < output.getNumChannels(); ++ch)
         juce::FloatVectorOperations::multiply(output.getChannelPointer(ch), comp, (int)numSm);
@@ -153,3 +185,6 @@ void SaturationProcessor::process(const juce::dsp::ProcessContextReplacing<float
 
 }
 
+template class BasicSaturationProcessor<float>;
+template class BasicSaturationProcessor<double>;
+
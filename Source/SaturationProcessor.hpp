@@ -10,7 +10,8 @@
 
 #include <JuceHeader.h>
 
-class SaturationProcessor : public juce::dsp::ProcessorBase
+// type and parameters shared by every sample type
+class SaturationProcessorBase
 {
 public:
     enum class Type { Tape, Tube, Transistor, Exciter };
@@ -23,16 +24,24 @@ public:
         float tone = 0.5f;
         float bias = 0.0f;
     };
+};
 
-    SaturationProcessor();
+template <typename SampleType>
+class BasicSaturationProcessor : public SaturationProcessorBase
+{
+public:
+    BasicSaturationProcessor();
 
-    void prepare(const juce::dsp::ProcessSpec& spec) override;
-    void process(const juce::dsp::ProcessContextReplacing<float>& context) override;
-    void reset() override;
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context);
+    void reset();
 
     void setParameters(const SaturationParameters& newParams);
     void setType(Type newType);
 
+    // whole samples of delay, whether the stage is driving or idle; valid after prepare()
+    int getLatencySamples() const noexcept { return latencySamples; }
+
 private:
     void updateWaveshaper();
     void updateToneFilter();
@@ -41,13 +50,26 @@ private:
     SaturationParameters params;
     Type currentType = Type::Tape;
 
-    juce::dsp::WaveShaper<float> shaper;
-    juce::dsp::IIR::Filter<float> toneFilter;
-    juce::dsp::DryWetMixer<float> dryWet;
-    std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
+    // the oversampler's half-band IIR delays the wet path by a few samples
+    static constexpr int maximumWetLatency = 64;
+
+    juce::dsp::WaveShaper<SampleType> shaper;
+    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<SampleType>,
+                                   juce::dsp::IIR::Coefficients<SampleType>> toneFilter;
+    juce::dsp::DryWetMixer<SampleType> dryWet { maximumWetLatency };
+    std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampler;
+
+    // tops the oversampler's fractional latency up to latencySamples,
+    // and delays by all of it while the stage is idle
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::Thiran> latencyPad { maximumWetLatency };
+    SampleType oversamplerLatency = 0;
+    int latencySamples = 0;
 
     float driveGain = 1.0f;
     double sampleRate = 44100.0;
+    double oversampledRate = 176400.0;   // the tone filter runs at this rate
 };
 
+using SaturationProcessor = BasicSaturationProcessor<float>;
+
 #endif 
@@ -0,0 +1,156 @@
+//
+//  ShimmerProcessor.cpp
+//  StringSauce
+//
+//  Implementation of the Shimmer module
+//
+//  Every hop a Hann-windowed grain is resampled out of the input
+//  ring at the pitch ratio and overlap-added into an output ring.
+//  Window and accumulation run through FloatVectorOperations; the
+//  only scalar work is the interpolated grain read.
+
+#include "ShimmerProcessor.hpp"
+
+ShimmerProcessor::ShimmerProcessor() {}
+
+void ShimmerProcessor::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate > 0.0 ? spec.sampleRate : 44100.0;
+    const size_t numCh = juce::jmax((size_t) 1, (size_t) spec.numChannels);
+
+    // ~30 ms grains, kept a power of two so every ring index is a mask
+    grainSize = juce::jlimit(256, 8192, juce::nextPowerOfTwo((int) (sampleRate * 0.03)));
+    hopSize   = grainSize / overlap;
+
+    // a grain at +12 st reads two grain lengths behind the write head
+    const int inputSize  = juce::nextPowerOfTwo(grainSize * 2 + hopSize + 8);
+    const int outputSize = juce::nextPowerOfTwo(grainSize + hopSize);
+
+    inputMask  = inputSize - 1;
+    outputMask = outputSize - 1;
+
+    inputRing.assign(numCh, std::vector<float>((size_t) inputSize, 0.0f));
+    outputAccum.assign(numCh, std::vector<float>((size_t) outputSize, 0.0f));
+    grain.assign((size_t) grainSize, 0.0f);
+
+    // periodic Hann, pre-scaled so the overlapping grains sum to unity
+    window.resize((size_t) grainSize);
+    const float norm = 2.0f / (float) overlap;
+
+    for (int i = 0; i < grainSize; ++i)
+        window[(size_t) i] = norm * (0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float) i / (float) grainSize));
+
+    setParameters(params);
+    reset();
+}
+
+void ShimmerProcessor::reset()
+{
+    for (auto& ring : inputRing)   std::fill(ring.begin(), ring.end(), 0.0f);
+    for (auto& ring : outputAccum) std::fill(ring.begin(), ring.end(), 0.0f);
+
+    writePos        = 0;
+    outputPos       = 0;
+    samplesUntilHop = 0;
+    needsReset      = false;
+}
+
+void ShimmerProcessor::setParameters(const ShimmerParameters& p)
+{
+    params = p;
+    ratio  = std::pow(2.0, juce::jlimit(-12.0f, 12.0f, params.pitchSemitones) / 12.0);
+
+    if (! isActive())
+        needsReset = true;
+}
+
+void ShimmerProcessor::spawnGrain(size_t ch)
+{
+    const auto& in = inputRing[ch];
+    auto& acc      = outputAccum[ch];
+
+    // start far enough back that the last read is already written
+    const double span = (double) (grainSize - 1) * ratio;
+    double readPos    = (double) (writePos + inputMask + 1) - std::ceil(span) - 3.0;
+
+    for (int i = 0; i < grainSize; ++i)
+    {
+        const int idx    = (int) readPos;
+        const float frac = (float) (readPos - (double) idx);
+        const float a    = in[(size_t) (idx & inputMask)];
+        const float b    = in[(size_t) ((idx + 1) & inputMask)];
+
+        grain[(size_t) i] = a + frac * (b - a);
+        readPos += ratio;
+    }
+
+    juce::FloatVectorOperations::multiply(grain.data(), window.data(), grainSize);
+
+    // overlap-add starting at the current output position
+    const int first = juce::jmin(grainSize, outputMask + 1 - outputPos);
+    juce::FloatVectorOperations::add(acc.data() + outputPos, grain.data(), first);
+
+    if (grainSize > first)
+        juce::FloatVectorOperations::add(acc.data(), grain.data() + first, grainSize - first);
+}
+
+void ShimmerProcessor::process(juce::dsp::AudioBlock<float>& block)
+{
+    if (inputRing.empty()) return;
+    if (needsReset) reset();
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    const size_t numCh = juce::jmin(block.getNumChannels(), inputRing.size());
+    const int numSm    = (int) block.getNumSamples();
+    const float gain   = juce::jlimit(0.0f, 1.0f, params.mix);
+
+    int done = 0;
+
+    while (done < numSm)
+    {
+        if (samplesUntilHop == 0)
+        {
+            for (size_t ch = 0; ch < numCh; ++ch)
+                spawnGrain(ch);
+
+            samplesUntilHop = hopSize;
+        }
+
+        const int seg      = juce::jmin(numSm - done, samplesUntilHop);
+        const int inFirst  = juce::jmin(seg, inputMask + 1 - writePos);
+        const int outFirst = juce::jmin(seg, outputMask + 1 - outputPos);
+
+        for (size_t ch = 0; ch < numCh; ++ch)
+        {
+            auto* data = block.getChannelPointer(ch) + done;
+            auto* in   = inputRing[ch].data();
+            auto* acc  = outputAccum[ch].data();
+
+            // store the dry send before anything is added to it
+            juce::FloatVectorOperations::copy(in + writePos, data, inFirst);
+            if (seg > inFirst)
+                juce::FloatVectorOperations::copy(in, data + inFirst, seg - inFirst);
+
+            // add the finished grain sum and clear what was consumed
+            juce::FloatVectorOperations::addWithMultiply(data, acc + outputPos, gain, outFirst);
+            juce::FloatVectorOperations::clear(acc + outputPos, outFirst);
+
+            if (seg > outFirst)
+            {
+                juce::FloatVectorOperations::addWithMultiply(data + outFirst, acc, gain, seg - outFirst);
+                juce::FloatVectorOperations::clear(acc, seg - outFirst);
+            }
+        }
+
+        writePos         = (writePos  + seg) & inputMask;
+        outputPos        = (outputPos + seg) & outputMask;
+        samplesUntilHop -= seg;
+        done            += seg;
+    }
+
+    // cost relative to the duration of the block
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    const float load     = (float) (elapsed * sampleRate / juce::jmax(1, numSm));
+    cpuLoad.store(0.9f * cpuLoad.load(std::memory_order_relaxed) + 0.1f * load, std::memory_order_relaxed);
+}
@@ -0,0 +1,80 @@
+//
+//  ShimmerProcessor.hpp
+//  StringSauce
+//
+//  Defines the Shimmer module: a granular pitch shifter
+//  that sits in the reverb send so only the wet path is shifted
+
+#ifndef ShimmerProcessor_hpp
+#define ShimmerProcessor_hpp
+#pragma once
+
+#include <JuceHeader.h>
+
+class ShimmerProcessor
+{
+public:
+    struct ShimmerParameters
+    {
+        float pitchSemitones    = 12.0f;   // [-12..+12]
+        float mix               = 0.0f;    // send amount added to the reverb input
+    };
+
+    ShimmerProcessor();
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    void setParameters(const ShimmerParameters& p);
+
+    // true when the stage has something to add; at mix == 0 it must not be called
+    bool isActive() const noexcept { return params.mix > 0.0f; }
+
+    // adds mix * pitchShifted(block) into block
+    void process(juce::dsp::AudioBlock<float>& block);
+
+    // call instead of process() while the stage is bypassed, so stale
+    // grains are flushed before the stage runs again
+    void skip() noexcept { needsReset = true; }
+
+    // fraction of the real-time budget spent in process(), smoothed
+    float getCpuLoad() const noexcept { return cpuLoad.load(std::memory_order_relaxed); }
+
+    size_t getMemoryUsageBytes() const noexcept
+    {
+        size_t floats = window.size() + grain.size();
+        for (auto& ring : inputRing)   floats += ring.size();
+        for (auto& ring : outputAccum) floats += ring.size();
+        return floats * sizeof(float);
+    }
+
+    // grains overlapping at any output sample, i.e. interpolated reads per sample and channel
+    static constexpr int overlap = 2;
+
+private:
+    void spawnGrain(size_t ch);
+
+    ShimmerParameters params;
+
+    // per-channel rings, allocated once in prepare
+    std::vector<std::vector<float>> inputRing;
+    std::vector<std::vector<float>> outputAccum;
+    std::vector<float> window;
+    std::vector<float> grain;
+
+    int grainSize       = 2048;
+    int hopSize         = 512;
+    int inputMask       = 0;
+    int outputMask      = 0;
+    int writePos        = 0;
+    int outputPos       = 0;
+    int samplesUntilHop = 0;
+
+    double sampleRate   = 44100.0;
+    double ratio        = 1.0;
+    bool needsReset     = true;
+
+    std::atomic<float> cpuLoad { 0.0f };
+};
+
+#endif
@@ -0,0 +1,38 @@
+//
+//  SilenceGate.cpp
+//  StringSauce
+//
+//  Implementation of the whole-chain silence gate
+
+#include "SilenceGate.hpp"
+
+SilenceGate::SilenceGate()
+{
+    setThresholdDecibels(-96.0f);
+}
+
+void SilenceGate::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    setHoldSeconds(holdSeconds);
+    reset();
+}
+
+void SilenceGate::reset()
+{
+    quietSamples  = 0;
+    inputWasQuiet = false;
+    sleeping      = false;
+}
+
+void SilenceGate::setHoldSeconds(double seconds)
+{
+    holdSeconds = juce::jmax(0.0, seconds);
+    holdSamples = (juce::int64) std::ceil(holdSeconds * sampleRate);
+}
+
+void SilenceGate::setThresholdDecibels(float dB)
+{
+    threshold = juce::Decibels::decibelsToGain(dB);
+    wakeLevel = juce::Decibels::decibelsToGain(dB + 6.0f);
+}
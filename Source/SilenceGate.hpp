@@ -0,0 +1,100 @@
+//
+//  SilenceGate.hpp
+//  StringSauce
+//
+//  Decides when the whole chain can sleep: the input has been
+//  silent and the output has stayed below the threshold for the
+//  hold time, so no tail is left to ring out. Any input above
+//  the wake level brings it back before that block is processed.
+
+#ifndef SilenceGate_hpp
+#define SilenceGate_hpp
+#pragma once
+
+#include <JuceHeader.h>
+
+class SilenceGate
+{
+public:
+    SilenceGate();
+
+    void prepare(double sampleRate);
+    void reset();
+
+    // quiet time needed before sleeping; must cover the longest gap between echoes
+    void setHoldSeconds(double seconds);
+
+    // sleep below this level; waking needs 6 dB more
+    void setThresholdDecibels(float dB);
+
+    // call before processing; true while the block can be skipped.
+    // a loud enough input wakes the gate and returns false
+    template <typename SampleType>
+    bool shouldSkip(const juce::dsp::AudioBlock<SampleType>& input)
+    {
+        inputWasQuiet = peakBelow(input, sleeping ? wakeLevel : threshold);
+
+        if (sleeping && ! inputWasQuiet)
+            sleeping = false;
+
+        if (sleeping)
+            sleptBlocks.fetch_add(1, std::memory_order_relaxed);
+
+        return sleeping;
+    }
+
+    // call after processing; true when the gate has just fallen asleep,
+    // so the caller can clear whatever state is left
+    template <typename SampleType>
+    bool processed(const juce::dsp::AudioBlock<SampleType>& output)
+    {
+        if (inputWasQuiet && peakBelow(output, threshold))
+            quietSamples += (juce::int64) output.getNumSamples();
+        else
+            quietSamples = 0;
+
+        if (quietSamples < holdSamples)
+            return false;
+
+        sleeping     = true;
+        quietSamples = 0;
+        return true;
+    }
+
+    bool isSleeping() const noexcept { return sleeping; }
+
+    // blocks skipped since the plugin was created, read from any thread
+    juce::uint64 getSleptBlocks() const noexcept { return sleptBlocks.load(std::memory_order_relaxed); }
+
+private:
+    template <typename SampleType>
+    static bool peakBelow(const juce::dsp::AudioBlock<SampleType>& block, float level)
+    {
+        const auto numSm = block.getNumSamples();
+
+        for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+        {
+            const auto* data = block.getChannelPointer(ch);
+
+            for (size_t i = 0; i < numSm; ++i)
+                if (std::abs(data[i]) >= (SampleType) level)
+                    return false;
+        }
+
+        return true;
+    }
+
+    double sampleRate        = 44100.0;
+    double holdSeconds       = 1.0;
+    float threshold          = 0.0f;
+    float wakeLevel          = 0.0f;
+
+    juce::int64 holdSamples  = 0;
+    juce::int64 quietSamples = 0;
+    bool inputWasQuiet       = false;
+    bool sleeping            = false;
+
+    std::atomic<juce::uint64> sleptBlocks { 0 };
+};
+
+#endif
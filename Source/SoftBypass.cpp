@@ -0,0 +1,154 @@
+//
+//  SoftBypass.cpp
+//  StringSauce
+//
+//  Implementation of the soft bypass
+
+#include "SoftBypass.hpp"
+
+namespace
+{
+    constexpr double fadeSeconds   = 0.02;
+    constexpr double warmUpSeconds = 0.01;
+}
+
+template <typename SampleType>
+SoftBypass<SampleType>::SoftBypass() {}
+
+template <typename SampleType>
+void SoftBypass<SampleType>::prepare(double sampleRate, int numChannels, int maximumBlockSize, int maximumLatency)
+{
+    const double sr = sampleRate > 0.0 ? sampleRate : 44100.0;
+    const int numCh = juce::jmax(1, numChannels);
+    const int block = juce::jmax(1, maximumBlockSize);
+
+    const int size = juce::nextPowerOfTwo(juce::jmax(0, maximumLatency) + block);
+    mask = size - 1;
+
+    ring.setSize(numCh, size);
+    dry.setSize(numCh, block);
+
+    fadeStep      = (float) (1.0 / juce::jmax(1.0, fadeSeconds * sr));
+    warmUpSamples = (int) std::ceil(warmUpSeconds * sr);
+
+    latency = juce::jlimit(0, mask + 1 - block, latency);
+    reset();
+}
+
+template <typename SampleType>
+void SoftBypass<SampleType>::reset()
+{
+    ring.clear();
+    writePos = 0;
+
+    // a bypassed instance stays bypassed across prepare
+    if (state == State::bypassed || state == State::fadingOut)
+    {
+        state   = State::bypassed;
+        wetGain = 0.0f;
+    }
+    else
+    {
+        state   = State::active;
+        wetGain = 1.0f;
+    }
+}
+
+template <typename SampleType>
+void SoftBypass<SampleType>::setLatency(int samples)
+{
+    latency = juce::jlimit(0, juce::jmax(0, mask + 1 - dry.getNumSamples()), samples);
+}
+
+template <typename SampleType>
+bool SoftBypass<SampleType>::pushDry(const juce::dsp::AudioBlock<SampleType>& block, int numInputChannels, bool shouldBypass)
+{
+    jassert((int) block.getNumSamples() <= getMaximumBlockSize());
+
+    const int numSm = juce::jmin((int) block.getNumSamples(), dry.getNumSamples());
+    const int numCh = juce::jmin((int) block.getNumChannels(), dry.getNumChannels());
+    const int numIn = juce::jlimit(1, juce::jmax(1, numCh), numInputChannels);
+
+    // extra outputs of a mono-in layout bypass to the mono input
+    for (int ch = 0; ch < numCh; ++ch)
+    {
+        const auto* in = block.getChannelPointer((size_t) juce::jmin(ch, numIn - 1));
+        auto* r        = ring.getWritePointer(ch);
+        auto* d        = dry.getWritePointer(ch);
+
+        for (int i = 0; i < numSm; ++i)
+        {
+            r[(writePos + i) & mask] = in[i];
+            d[i] = r[(writePos + i - latency) & mask];
+        }
+    }
+
+    writePos = (writePos + numSm) & mask;
+
+    switch (state)
+    {
+        case State::active:    if (shouldBypass) state = State::fadingOut; break;
+        case State::fadingIn:  if (shouldBypass) state = State::fadingOut; break;
+        case State::fadingOut: if (! shouldBypass) state = State::fadingIn; break;
+        case State::warmingUp: if (shouldBypass) state = State::bypassed;  break;
+
+        case State::bypassed:
+            if (! shouldBypass)
+            {
+                state          = State::warmingUp;
+                warmUpLeft     = warmUpSamples;
+                resetRequested = true;
+            }
+            break;
+    }
+
+    return state != State::bypassed;
+}
+
+template <typename SampleType>
+void SoftBypass<SampleType>::mix(juce::dsp::AudioBlock<SampleType>& block)
+{
+    if (state == State::active) return;
+
+    const int numSm = juce::jmin((int) block.getNumSamples(), dry.getNumSamples());
+    const int numCh = juce::jmin((int) block.getNumChannels(), dry.getNumChannels());
+
+    if (state == State::bypassed || state == State::warmingUp)
+    {
+        for (int ch = 0; ch < numCh; ++ch)
+            juce::FloatVectorOperations::copy(block.getChannelPointer((size_t) ch), dry.getReadPointer(ch), numSm);
+
+        if (state == State::warmingUp)
+        {
+            warmUpLeft -= numSm;
+            if (warmUpLeft <= 0)
+                state = State::fadingIn;
+        }
+        return;
+    }
+
+    // linear fade, picked up from wherever the last one stopped
+    const float step  = state == State::fadingIn ? fadeStep : -fadeStep;
+    const float start = wetGain;
+
+    for (int ch = 0; ch < numCh; ++ch)
+    {
+        auto* out     = block.getChannelPointer((size_t) ch);
+        const auto* d = dry.getReadPointer(ch);
+        float g       = start;
+
+        for (int i = 0; i < numSm; ++i)
+        {
+            g = juce::jlimit(0.0f, 1.0f, g + step);
+            out[i] = d[i] + (SampleType) g * (out[i] - d[i]);
+        }
+
+        wetGain = g;
+    }
+
+    if (wetGain >= 1.0f)      state = State::active;
+    else if (wetGain <= 0.0f) state = State::bypassed;
+}
+
+template class SoftBypass<float>;
+template class SoftBypass<double>;
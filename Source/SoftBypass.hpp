@@ -0,0 +1,60 @@
+//
+//  SoftBypass.hpp
+//  StringSauce
+//
+//  Click-free bypass: crossfades between the processed block and
+//  the input delayed by the reported latency. Once fully bypassed
+//  the chain is skipped; switching back resets it, lets it run
+//  muted for a short warm-up and only then fades it in.
+
+#ifndef SoftBypass_hpp
+#define SoftBypass_hpp
+#pragma once
+
+#include <JuceHeader.h>
+
+template <typename SampleType>
+class SoftBypass
+{
+public:
+    SoftBypass();
+
+    // maximumLatency sizes the dry delay; setLatency may move within it
+    void prepare(double sampleRate, int numChannels, int maximumBlockSize, int maximumLatency);
+    void reset();
+
+    void setLatency(int samples);
+
+    // the dry copy holds one prepared block; longer host blocks have to be
+    // passed through pushDry/process/mix in pieces of at most this size
+    int getMaximumBlockSize() const noexcept { return dry.getNumSamples(); }
+
+    // call before processing with the block still holding the input.
+    // stores the delayed dry signal and returns false while the chain can be skipped
+    bool pushDry(const juce::dsp::AudioBlock<SampleType>& block, int numInputChannels, bool shouldBypass);
+
+    // true once after the chain has slept, so it can be reset before warming up
+    bool takeResetRequest() noexcept { return std::exchange(resetRequested, false); }
+
+    // call after processing; blends the stored dry signal into block
+    void mix(juce::dsp::AudioBlock<SampleType>& block);
+
+private:
+    enum class State { active, fadingOut, bypassed, warmingUp, fadingIn };
+
+    State state         = State::active;
+    bool resetRequested = false;
+
+    juce::AudioBuffer<SampleType> ring;
+    juce::AudioBuffer<SampleType> dry;
+    int mask     = 0;
+    int writePos = 0;
+    int latency  = 0;
+
+    float wetGain     = 1.0f;
+    float fadeStep    = 0.0f;
+    int warmUpSamples = 0;
+    int warmUpLeft    = 0;
+};
+
+#endif
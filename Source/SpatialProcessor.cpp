@@ -10,33 +10,117 @@
 
 #include "SpatialProcessor.hpp"
 
+namespace
+{
+    constexpr float msCoeff = 0.70710678f;
+
+    // in place: L -> M, R -> S
+    void encodeMidSide(float* L, float* R, float* tmp, int n)
+    {
+        juce::FloatVectorOperations::copy(tmp, L, n);
+        juce::FloatVectorOperations::add(L, R, n);
+        juce::FloatVectorOperations::multiply(L, msCoeff, n);
+        juce::FloatVectorOperations::subtract(R, tmp, R, n);
+        juce::FloatVectorOperations::multiply(R, msCoeff, n);
+    }
+
+    // without the 0.7071, matching applyStereoWidth's overall level
+    void decodeMidSide(float* M, float* S, float* tmp, int n)
+    {
+        juce::FloatVectorOperations::copy(tmp, M, n);
+        juce::FloatVectorOperations::add(M, S, n);
+        juce::FloatVectorOperations::subtract(S, tmp, S, n);
+    }
+}
+
 SpatialProcessor::SpatialProcessor() {}
 
 void SpatialProcessor::prepare(const juce::dsp::ProcessSpec& spec)
 {
-    sampleRate = spec.sampleRate;
-    maxDelaySamples = (size_t) juce::roundToInt(sampleRate * 1.5);
+    // buffers are already sized for this spec
+    if (spec.sampleRate       == preparedSpec.sampleRate
+     && spec.maximumBlockSize == preparedSpec.maximumBlockSize
+     && spec.numChannels      == preparedSpec.numChannels)
+    {
+        reset();
+        return;
+    }
 
-    delayL.prepare(spec);
-    delayR.prepare(spec);
-    delayL.setMaximumDelayInSamples((int)maxDelaySamples);
-    delayR.setMaximumDelayInSamples((int)maxDelaySamples);
-    delayL.reset();
-    delayR.reset();
+    preparedSpec = spec;
+    hostRate = spec.sampleRate;
+
+    const int numCh    = (int) spec.numChannels;
+    const int maxBlock = (int) spec.maximumBlockSize;
+
+    // wet paths run at 1/2 or 1/4 of high host rates, never below 44 kHz
+    int numStages = 0;
+    while (numStages < 2 && hostRate / (double) (2 << numStages) >= 44000.0)
+        ++numStages;
+
+    rateFactor = 1 << numStages;
+    wetRate    = hostRate / (double) rateFactor;
+    int wetBlock = maxBlock;
+
+    if (rateFactor > 1)
+    {
+        resampler.prepare(numCh, maxBlock, numStages);
+        wetBlock = resampler.getMaximumLowBlockSize();
+
+        lowBuffer.setSize(numCh, wetBlock);
+        lowDry   .setSize(numCh, wetBlock);
+        upBuffer .setSize(numCh, maxBlock);
+    }
+    else
+    {
+        resampler.prepare(numCh, maxBlock, 0);
+
+        lowBuffer.setSize(0, 0);
+        lowDry   .setSize(0, 0);
+        upBuffer .setSize(0, 0);
+    }
+
+    const juce::dsp::ProcessSpec wetSpec { wetRate, (juce::uint32) wetBlock, spec.numChannels };
 
-    chorus.prepare(spec);
-    reverb.prepare(spec);
+    maxDelaySamples = (int) std::ceil(maxDelayTimeMs * 0.001 * wetRate);
 
-    delayMix.prepare(spec);
-    chorusMix.prepare(spec);
-    reverbMix.prepare(spec);
+    const auto storage = compactStorage ? FeedbackDelay::Storage::compact
+                                        : FeedbackDelay::Storage::full;
+    delayL.setStorage(storage);
+    delayR.setStorage(storage);
+
+    delayL.prepare(wetRate, maxDelaySamples, wetBlock);
+    delayR.prepare(wetRate, maxDelaySamples, wetBlock);
+
+    chorus.prepare(wetSpec);
+    reverb.prepare(wetSpec);
+    shimmer.prepare(wetSpec);
+
+    // same ramp time as the DryWetMixers these replace
+    delayWet .reset(wetRate, 0.05);
+    chorusWet.reset(wetRate, 0.05);
+    reverbWet.reset(wetRate, 0.05);
+    reducedDry.reset(hostRate, 0.05);
+
+    dryScratch.setSize(numCh, maxBlock);
+    gainRamp.assign((size_t) maxBlock, 0.0f);
+    dryGain .assign((size_t) maxBlock, 0.0f);
+    monoWet .assign((size_t) maxBlock, 0.0f);
 
     updateDelay();
     updateChorus();
     updateReverb();
+    reset();
 }
 
+void SpatialProcessor::setCompactStorage(bool shouldBeCompact)
+{
+    if (shouldBeCompact == compactStorage) return;
 
+    compactStorage = shouldBeCompact;
+
+    // force the next prepare to reallocate
+    preparedSpec = { 0.0, 0, 0 };
+}
 
 void SpatialProcessor::reset()
 {
@@ -44,41 +128,122 @@ void SpatialProcessor::reset()
     delayR.reset();
     chorus.reset();
     reverb.reset();
-
-    delayMix.reset();
-    chorusMix.reset();
-    reverbMix.reset();
+    shimmer.reset();
+    resampler.reset();
+    resamplerStale = false;
+
+    delayWet .setCurrentAndTargetValue(delayWet.getTargetValue());
+    chorusWet.setCurrentAndTargetValue(chorusWet.getTargetValue());
+    reverbWet.setCurrentAndTargetValue(reverbWet.getTargetValue());
+    reducedDry.setCurrentAndTargetValue(reducedDry.getTargetValue());
 }
 
 void SpatialProcessor::setParameters(const SpatialParameters& p)
 {
+    const bool delayChanged = p.delayTimeLeft  != params.delayTimeLeft
+                           || p.delayTimeRight != params.delayTimeRight;
     params = p;
 
-    updateDelay();
+    if (delayChanged)
+        updateDelay();
     updateChorus();
     updateReverb();
 
-    delayMix.setWetMixProportion(params.delayMix);
-    chorusMix.setWetMixProportion(params.chorusMix);
-    reverbMix.setWetMixProportion(params.reverbMix);
+    delayWet.setTargetValue(params.delayMix);
+    // the old juce::dsp::Chorus blended 50/50 internally; the chorus is now wet-only
+    chorusWet.setTargetValue(params.chorusMix * 0.5f);
+    reverbWet.setTargetValue(params.reverbMix);
 }
 
-void SpatialProcessor::updateDelay()
+size_t SpatialProcessor::getMemoryUsageBytes() const
 {
-    // convert ms to samples
-    const float dL = (params.delayTimeLeft  / 1000.0f) * (float) sampleRate;
-    const float dR = (params.delayTimeRight / 1000.0f) * (float) sampleRate;
+    const auto numCh = (size_t) preparedSpec.numChannels;
+
+    size_t bytes = sizeof(*this)
+                 + delayL.getMemoryUsageBytes()
+                 + delayR.getMemoryUsageBytes()
+                 + chorus.getMemoryUsageBytes()
+                 + shimmer.getMemoryUsageBytes()
+                 + resampler.getMemoryUsageBytes();
+
+    // scratch
+    for (auto* b : { &dryScratch, &lowBuffer, &lowDry, &upBuffer })
+        bytes += (size_t) (b->getNumChannels() * b->getNumSamples()) * sizeof(float);
+
+    bytes += (gainRamp.size() + dryGain.size() + monoWet.size()) * sizeof(float);
+
+    // reverb combs + allpasses per channel, JUCE-owned, estimated from its prepare() sizing
+    bytes += numCh * (size_t) std::ceil((11024 + 1563) * wetRate / 44100.0) * sizeof(float);
 
-    delayL.setDelay(juce::jlimit(1.0f, (float)maxDelaySamples - 1.0f, dL));
-    delayR.setDelay(juce::jlimit(1.0f, (float)maxDelaySamples - 1.0f, dR));
+    return bytes;
+}
+
+double SpatialProcessor::estimateTailSeconds(const SpatialParameters& p, float floorDb)
+{
+    // passes of a loop with gain g until a signal at startDb is below floorDb
+    auto passesToFloor = [floorDb](float g, float startDb)
+    {
+        if (g <= 0.0f || startDb <= floorDb) return 0.0;
+        return std::ceil((double) (floorDb - startDb) / (20.0 * std::log10((double) g)));
+    };
+
+    double seconds = 0.0;
+
+    if (p.delayMix > 0.0f)
+    {
+        // every echo is the previous one times feedback, the first at mix
+        const double period = juce::jmin((double) maxDelayTimeMs, (double) juce::jmax(p.delayTimeLeft, p.delayTimeRight)) * 0.001;
+        const float fb      = juce::jlimit(0.0f, 0.99f, p.delayFeedback);
+        const float firstDb = juce::Decibels::gainToDecibels(p.delayMix, floorDb);
+
+        seconds += period * (1.0 + passesToFloor(fb, firstDb));
+    }
+
+    if (p.reverbMix > 0.0f)
+    {
+        // freeverb combs: feedback = room * 0.28 + 0.7, longest loop 1640 samples at 44.1 kHz.
+        // damping only shortens the highs, so it is left out
+        const float roomFb    = juce::jlimit(0.0f, 1.0f, p.reverbSize) * 0.28f + 0.7f;
+        const float firstDb   = juce::Decibels::gainToDecibels(p.reverbMix, floorDb);
+        const double loopTime = 1640.0 / 44100.0;
+
+        seconds += loopTime * passesToFloor(roomFb, firstDb);
+    }
+
+    // chorus modulation and shimmer grains only hold a few tens of ms
+    if (seconds > 0.0 || p.chorusMix > 0.0f)
+        seconds += 0.1;
+
+    return seconds;
+}
+
+double SpatialProcessor::longestTailGapSeconds(const SpatialParameters& p)
+{
+    if (p.delayMix <= 0.0f) return 0.0;
+    return juce::jmin((double) maxDelayTimeMs, (double) juce::jmax(p.delayTimeLeft, p.delayTimeRight)) * 0.001;
+}
+
+void SpatialProcessor::setShimmerParameters(const ShimmerProcessor::ShimmerParameters& p)
+{
+    shimmer.setParameters(p);
+}
+
+void SpatialProcessor::updateDelay()
+{
+    // convert ms to samples, less what the resampler round trip already delays by
+    const float latency = (float) getWetLatencySamples() / (float) rateFactor;
+    const float dL = (params.delayTimeLeft  / 1000.0f) * (float) wetRate - latency;
+    const float dR = (params.delayTimeRight / 1000.0f) * (float) wetRate - latency;
+
+    // clamped to the line's range, glides are handled inside
+    delayL.setDelay(dL);
+    delayR.setDelay(dR);
 }
 
 void SpatialProcessor::updateChorus()
 {
     chorus.setRate (juce::jlimit(0.01f, 5.0f, params.chorusRate));
     chorus.setDepth(juce::jlimit(0.0f, 1.0f, params.chorusDepth));
-    chorus.setCentreDelay(7.0f);
-    chorus.setFeedback(0.0f);
 }
 
 void SpatialProcessor::updateReverb()
@@ -110,11 +275,45 @@ void SpatialProcessor::applyStereoWidth(juce::dsp::AudioBlock<float>& block, flo
     }
 }
 
+void SpatialProcessor::fillGainRamp(juce::LinearSmoothedValue<float>& gain, int numSamples)
+{
+    if (! gain.isSmoothing())
+    {
+        juce::FloatVectorOperations::fill(gainRamp.data(), gain.getTargetValue(), numSamples);
+        return;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+        gainRamp[(size_t) i] = gain.getNextValue();
+}
+
+void SpatialProcessor::mixStage(juce::dsp::AudioBlock<float>& block,
+                                juce::LinearSmoothedValue<float>& wet,
+                                float* dryGainOut)
+{
+    const int n = (int) block.getNumSamples();
+    fillGainRamp(wet, n);
+
+    // y = dry + g * (wet - dry)
+    for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+    {
+        auto* y = block.getChannelPointer(ch);
+        const auto* d = dryScratch.getReadPointer((int) ch);
+
+        juce::FloatVectorOperations::subtract(y, d, n);
+        juce::FloatVectorOperations::multiply(y, gainRamp.data(), n);
+        juce::FloatVectorOperations::add(y, d, n);
+    }
+
+    // the dry signal that survives is scaled by (1 - g)
+    if (dryGainOut != nullptr)
+        juce::FloatVectorOperations::subtractWithMultiply(dryGainOut, dryGainOut, gainRamp.data(), n);
+}
+
 void SpatialProcessor::process(const juce::dsp::ProcessContextReplacing<float>& ctx)
 {
     auto& block = ctx.getOutputBlock();
     const size_t numCh = block.getNumChannels();
-    const size_t numSm = block.getNumSamples();
     
     const auto& p = params;
     const bool allDry =
@@ -123,55 +322,211 @@ void SpatialProcessor::process(const juce::dsp::ProcessContextReplacing<float>&
         p.chorusMix <= 0.0001f &&
         std::abs(p.stereoWidth - 1.0f) < 0.001f;
 
-    if (allDry) return;
+    if (allDry)
+    {
+        shimmer.skip();
+        resamplerStale = true;
+        return;
+    }
+
+    // a mode switch starts the other path from clean state
+    const auto mode = numCh > 1 ? requestedMode.load() : StereoMode::LeftRight;
+    if (mode != activeMode)
+    {
+        activeMode = mode;
+        chorus.reset();
+        reverb.reset();
+        shimmer.skip();
+        resamplerStale = true;
+    }
 
+    if (rateFactor > 1)
+    {
+        processReducedRate(block);
+        return;
+    }
+
+    processWet(block, nullptr);
+    applyWidth(block);
+}
+
+void SpatialProcessor::processWet(juce::dsp::AudioBlock<float>& block, float* dryGainOut)
+{
+    const size_t numCh = block.getNumChannels();
+    const int n        = (int) block.getNumSamples();
+
+    if (dryGainOut != nullptr)
+        juce::FloatVectorOperations::fill(dryGainOut, 1.0f, n);
 
     // delay
-    delayMix.pushDrySamples(block);
+    const float fb = juce::jlimit(0.0f, 0.99f, params.delayFeedback);
 
     for (size_t ch = 0; ch < numCh; ++ch)
+        dryScratch.copyFrom((int) ch, 0, block.getChannelPointer(ch), n);
+
+    delayL.process(block.getChannelPointer(0), n, fb);
+    if (numCh > 1)
+        delayR.process(block.getChannelPointer(1), n, fb);
+
+    mixStage(block, delayWet, dryGainOut);
+
+    if (activeMode == StereoMode::MidSide)
     {
-        auto* data = block.getChannelPointer(ch);
+        encodeMidSide(block.getChannelPointer(0), block.getChannelPointer(1), dryScratch.getWritePointer(0), n);
+        processSends(block, dryGainOut);
+        return;
+    }
 
-        for (size_t i = 0; i < numSm; ++i)
-        {
-            const float in  = data[i];
-            float dOut = 0.0f;
+    // chorus
+    for (size_t ch = 0; ch < numCh; ++ch)
+        dryScratch.copyFrom((int) ch, 0, block.getChannelPointer(ch), n);
+
+    chorus.process(block);
+    mixStage(block, chorusWet, dryGainOut);
 
-            if (ch == 0)
-            {
-                dOut = delayL.popSample(0);
-                float fb = juce::jlimit(0.0f, 0.99f, params.delayFeedback);
-                delayL.pushSample(0, in + dOut * fb);
-            }
-            else
-            {
-                dOut = delayR.popSample(0);
-                float fb = juce::jlimit(0.0f, 0.99f, params.delayFeedback);
-                delayR.pushSample(0, in + dOut * fb);
-            }
-            data[i] = dOut;
-        }
+    // reverb
+    for (size_t ch = 0; ch < numCh; ++ch)
+        dryScratch.copyFrom((int) ch, 0, block.getChannelPointer(ch), n);
+
+    // shimmer is added to the reverb send, so it only ever reaches the wet path
+    if (shimmer.isActive() && params.reverbMix > 0.0001f)
+        shimmer.process(block);
+    else
+        shimmer.skip();
+
+    {
+        juce::dsp::ProcessContextReplacing<float> rvCtx(block);
+        reverb.process(rvCtx);
     }
+    mixStage(block, reverbWet, dryGainOut);
+}
 
-    delayMix.mixWetSamples(block);
+void SpatialProcessor::processSends(juce::dsp::AudioBlock<float>& block, float* dryGainOut)
+{
+    const int n = (int) block.getNumSamples();
+    auto* M       = block.getChannelPointer(0);
+    auto* S       = block.getChannelPointer(1);
+    auto* wet     = monoWet.data();
 
-    // chorus
-    chorusMix.pushDrySamples(block);
+    float* wetChannels[] = { wet };
+    juce::dsp::AudioBlock<float> wetBlock(wetChannels, 1, (size_t) n);
+
+    // mid and side are scaled by (1 - g) like each L/R mix stage, so switching modes keeps the level
+    auto duckDry = [&]
     {
-        juce::dsp::ProcessContextReplacing<float> chorusCtx(block);
-        chorus.process(chorusCtx);
+        juce::FloatVectorOperations::subtractWithMultiply(M, M, gainRamp.data(), n);
+        juce::FloatVectorOperations::subtractWithMultiply(S, S, gainRamp.data(), n);
+
+        if (dryGainOut != nullptr)
+            juce::FloatVectorOperations::subtractWithMultiply(dryGainOut, dryGainOut, gainRamp.data(), n);
+    };
+
+    // chorus: mono from mid, wet only into side
+    if (chorusWet.isSmoothing() || chorusWet.getTargetValue() > 0.0001f)
+    {
+        juce::FloatVectorOperations::copy(wet, M, n);
+        chorus.process(wetBlock);
+
+        fillGainRamp(chorusWet, n);
+        duckDry();
+        juce::FloatVectorOperations::addWithMultiply(S, wet, gainRamp.data(), n);
     }
-    chorusMix.mixWetSamples(block);
 
-    // reverb
-    reverbMix.pushDrySamples(block);
+    // reverb: same, with the shimmer in its send
+    if (reverbWet.isSmoothing() || reverbWet.getTargetValue() > 0.0001f)
     {
-        juce::dsp::ProcessContextReplacing<float> rvCtx(block);
+        juce::FloatVectorOperations::copy(wet, M, n);
+
+        if (shimmer.isActive())
+            shimmer.process(wetBlock);
+        else
+            shimmer.skip();
+
+        juce::dsp::ProcessContextReplacing<float> rvCtx(wetBlock);
         reverb.process(rvCtx);
+
+        fillGainRamp(reverbWet, n);
+        duckDry();
+        juce::FloatVectorOperations::addWithMultiply(S, wet, gainRamp.data(), n);
+    }
+    else
+    {
+        shimmer.skip();
+    }
+}
+
+void SpatialProcessor::applyWidth(juce::dsp::AudioBlock<float>& block)
+{
+    const float width = juce::jlimit(0.0f, 2.0f, params.stereoWidth);
+
+    if (activeMode != StereoMode::MidSide)
+    {
+        applyStereoWidth(block, width);
+        return;
+    }
+
+    // block is still M/S: width is a single gain on side
+    const int n = (int) block.getNumSamples();
+    juce::FloatVectorOperations::multiply(block.getChannelPointer(1), width, n);
+    decodeMidSide(block.getChannelPointer(0), block.getChannelPointer(1), dryScratch.getWritePointer(0), n);
+}
+
+void SpatialProcessor::processReducedRate(juce::dsp::AudioBlock<float>& block)
+{
+    const size_t numCh = block.getNumChannels();
+    const int n        = (int) block.getNumSamples();
+    const bool midSide = activeMode == StereoMode::MidSide;
+
+    if (resamplerStale)
+    {
+        resampler.reset();
+        resamplerStale = false;
+    }
+
+    // run every wet path at the internal rate
+    const int numLow = resampler.downsample(block, lowBuffer);
+
+    auto lowBlock = juce::dsp::AudioBlock<float>(lowBuffer)
+                        .getSubsetChannelBlock(0, numCh)
+                        .getSubBlock(0, (size_t) numLow);
+
+    for (size_t ch = 0; ch < numCh; ++ch)
+        lowDry.copyFrom((int) ch, 0, lowBuffer, (int) ch, 0, numLow);
+
+    processWet(lowBlock, dryGain.data());
+
+    // keep only what the wet paths added; the dry part stays at the host rate
+    if (midSide)
+        encodeMidSide(lowDry.getWritePointer(0), lowDry.getWritePointer(1), dryScratch.getWritePointer(0), numLow);
+
+    for (size_t ch = 0; ch < numCh; ++ch)
+        juce::FloatVectorOperations::subtractWithMultiply(lowBlock.getChannelPointer(ch),
+                                                          lowDry.getReadPointer((int) ch),
+                                                          dryGain.data(), numLow);
+
+    auto upBlock = juce::dsp::AudioBlock<float>(upBuffer)
+                       .getSubsetChannelBlock(0, numCh)
+                       .getSubBlock(0, (size_t) n);
+
+    resampler.upsample(lowBuffer, numLow, upBlock);
+
+    // host-rate dry, in the same domain as the wet residual
+    if (midSide)
+        encodeMidSide(block.getChannelPointer(0), block.getChannelPointer(1), dryScratch.getWritePointer(0), n);
+
+    // both modes scale the dry by every stage's (1 - wet)
+    const float dryTarget = (1.0f - delayWet.getTargetValue())
+                          * (1.0f - chorusWet.getTargetValue())
+                          * (1.0f - reverbWet.getTargetValue());
+    reducedDry.setTargetValue(dryTarget);
+    fillGainRamp(reducedDry, n);
+
+    for (size_t ch = 0; ch < numCh; ++ch)
+    {
+        auto* x = block.getChannelPointer(ch);
+        juce::FloatVectorOperations::multiply(x, gainRamp.data(), n);
+        juce::FloatVectorOperations::add(x, upBlock.getChannelPointer(ch), n);
     }
-    reverbMix.mixWetSamples(block);
 
-    // widening
-    applyStereoWidth(block, juce::jlimit(0.0f, 2.0f, params.stereoWidth));
+    applyWidth(block);
 }
@@ -9,10 +9,17 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ShimmerProcessor.hpp"
+#include "FeedbackDelay.hpp"
+#include "StereoChorus.hpp"
+#include "WetResampler.hpp"
 
 class SpatialProcessor : public juce::dsp::ProcessorBase
 {
 public:
+    // longest delay time ParameterMapper::mapSpatial may produce; sizes the delay lines
+    static constexpr float maxDelayTimeMs = 750.0f;
+
     struct SpatialParameters
     {
         // reverb
@@ -36,6 +43,12 @@ public:
         float chorusMix         = 0.0f;    
     };
 
+    // MidSide encodes once after the delay, feeds chorus and reverb from
+    // mid into side and applies width as a gain on side before decoding.
+    // the sends duck the dry signal as LeftRight's mixes do, so levels match.
+    // the plugin and renderer select it for mono-in layouts
+    enum class StereoMode { LeftRight, MidSide };
+
     SpatialProcessor();
 
     void prepare (const juce::dsp::ProcessSpec& spec) override;
@@ -43,32 +56,84 @@ public:
     void reset   () override;
 
     void setParameters(const SpatialParameters& p);
+    void setShimmerParameters(const ShimmerProcessor::ShimmerParameters& p);
+
+    float getShimmerCpuLoad() const noexcept { return shimmer.getCpuLoad(); }
+
+    // keep delay history as int16; reallocates at the next prepare()
+    void setCompactStorage(bool shouldBeCompact);
+
+    // safe to call while processing; takes effect at the next block
+    void setStereoMode(StereoMode mode) noexcept { requestedMode.store(mode); }
+    StereoMode getStereoMode() const noexcept    { return requestedMode.load(); }
+
+    // bytes held by this instance's buffers once prepared
+    size_t getMemoryUsageBytes() const;
+
+    // rate the delay, chorus and reverb run at; below the host rate above ~88 kHz
+    double getWetSampleRate() const noexcept { return wetRate; }
+
+    // host samples chorus and reverb trail the dry signal by; the delay is compensated
+    int getWetLatencySamples() const noexcept { return rateFactor > 1 ? resampler.getLatencyInSamples() : 0; }
+
+    // seconds until the wet paths fall below floorDb after the input stops,
+    // excluding the resampler latency
+    static double estimateTailSeconds(const SpatialParameters& p, float floorDb = -90.0f);
+
+    // longest stretch of silence that can sit inside a tail, i.e. one echo period
+    static double longestTailGapSeconds(const SpatialParameters& p);
 
 private:
     SpatialParameters params;
 
     // delay lines
-    using DL = juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::Lagrange3rd>;
-    DL delayL { 48000 }, delayR { 48000 }; 
+    FeedbackDelay delayL, delayR;
 
     // chorus and reverb
-    juce::dsp::Chorus<float> chorus;
+    StereoChorus chorus;
     juce::dsp::Reverb reverb;
     juce::dsp::Reverb::Parameters rvParams;
 
-    // mixers
-    juce::dsp::DryWetMixer<float> delayMix;
-    juce::dsp::DryWetMixer<float> chorusMix;
-    juce::dsp::DryWetMixer<float> reverbMix;
+    // pitch shifter in the reverb send
+    ShimmerProcessor shimmer;
+
+    // wet gains: crossfades in L/R, sends from mid into side in M/S
+    juce::LinearSmoothedValue<float> delayWet, chorusWet, reverbWet;
+
+    std::atomic<StereoMode> requestedMode { StereoMode::LeftRight };
+    StereoMode activeMode = StereoMode::LeftRight;
 
-    double sampleRate = 44100.0;
-    size_t maxDelaySamples = 48000;
+    // reduced-rate wet paths; reducedDry is the surviving dry gain at the host rate
+    WetResampler resampler;
+    juce::LinearSmoothedValue<float> reducedDry { 1.0f };
+    juce::AudioBuffer<float> lowBuffer, lowDry, upBuffer;
+    int rateFactor      = 1;
+    bool resamplerStale = false;
+
+    // dry copy per stage, per-sample gains and the mono send
+    juce::AudioBuffer<float> dryScratch;
+    std::vector<float> gainRamp, dryGain, monoWet;
+
+    double hostRate = 44100.0;
+    double wetRate  = 44100.0;
+    int maxDelaySamples = 0;
+    bool compactStorage = false;
+
+    // spec of the last prepare, so an identical one only resets
+    juce::dsp::ProcessSpec preparedSpec { 0.0, 0, 0 };
 
     // helpers
     void updateDelay();
     void updateChorus();
     void updateReverb();
     void applyStereoWidth(juce::dsp::AudioBlock<float>& block, float width);
+
+    void processWet(juce::dsp::AudioBlock<float>& block, float* dryGainOut);
+    void processReducedRate(juce::dsp::AudioBlock<float>& block);
+    void processSends(juce::dsp::AudioBlock<float>& block, float* dryGainOut);
+    void mixStage(juce::dsp::AudioBlock<float>& block, juce::LinearSmoothedValue<float>& wet, float* dryGainOut);
+    void applyWidth(juce::dsp::AudioBlock<float>& block);
+    void fillGainRamp(juce::LinearSmoothedValue<float>& gain, int numSamples);
 };
 
 #endif 
@@ -0,0 +1,142 @@
+//
+//  SpectrumAnalyzer.cpp
+//  StringSauce
+//
+//  Implementation of the background spectrum analyzer
+
+#include "SpectrumAnalyzer.hpp"
+
+namespace
+{
+    // per-frame weight of the previous value; ~0.2 s to settle at 30 fps
+    constexpr float smoothing = 0.7f;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : juce::Thread("StringSauce Analyzer")
+{
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    setEnabled(false);
+}
+
+void SpectrumAnalyzer::prepare(double newSampleRate)
+{
+    sampleRate.store(newSampleRate > 0.0 ? newSampleRate : 44100.0);
+}
+
+void SpectrumAnalyzer::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled == isEnabled()) return;
+
+    if (shouldBeEnabled)
+    {
+        startThread();
+        enabled.store(true);
+    }
+    else
+    {
+        enabled.store(false);
+        stopThread(500);
+    }
+}
+
+bool SpectrumAnalyzer::getLatestFrame(Frame& dest)
+{
+    if (! frames.update()) return false;
+
+    dest = frames.getReadSlot();
+    return true;
+}
+
+float SpectrumAnalyzer::getBinFrequency(int bin) noexcept
+{
+    const float t = ((float) bin + 0.5f) / (float) numBins;
+    return minFrequency * std::pow(maxFrequency / minFrequency, t);
+}
+
+void SpectrumAnalyzer::run()
+{
+    // whatever piled up while disabled is stale
+    for (auto* c : { &pre, &post })
+    {
+        c->fifo.finishedRead(c->fifo.getNumReady());
+        std::fill(c->history.begin(), c->history.end(), 0.0f);
+        c->smoothed.fill(floorDb);
+    }
+
+    while (! threadShouldExit())
+    {
+        const double rate = sampleRate.load();
+
+        // FFT bin ranges for each log-spaced display bin, redone when the rate moves
+        if (rate != edgesRate)
+        {
+            const float binHz = (float) (rate / fftSize);
+
+            for (int b = 0; b <= numBins; ++b)
+            {
+                const float f = minFrequency * std::pow(maxFrequency / minFrequency, (float) b / (float) numBins);
+                binEdges[(size_t) b] = juce::jlimit(1, fftSize / 2, (int) std::round(f / binHz));
+            }
+
+            edgesRate = rate;
+        }
+
+        auto& frame = frames.getWriteSlot();
+        analyse(pre,  frame.pre);
+        analyse(post, frame.post);
+        frame.sampleRate = rate;
+        frames.publish();
+
+        wait(1000 / frameRateHz);
+    }
+}
+
+void SpectrumAnalyzer::analyse(Channel& c, std::array<float, numBins>& out)
+{
+    // slide the newest samples into the analysis window
+    const int ready = c.fifo.getNumReady();
+    const int take  = juce::jmin(ready, fftSize);
+    const int skip  = ready - take;
+
+    c.fifo.finishedRead(skip);
+
+    int start1, size1, start2, size2;
+    c.fifo.prepareToRead(take, start1, size1, start2, size2);
+
+    auto* hist = c.history.data();
+    std::memmove(hist, hist + take, sizeof(float) * (size_t) (fftSize - take));
+    juce::FloatVectorOperations::copy(hist + fftSize - take, c.ring.data() + start1, size1);
+    juce::FloatVectorOperations::copy(hist + fftSize - take + size1, c.ring.data() + start2, size2);
+    c.fifo.finishedRead(size1 + size2);
+
+    // windowed magnitude spectrum
+    juce::FloatVectorOperations::copy(fftData.data(), hist, fftSize);
+    juce::FloatVectorOperations::clear(fftData.data() + fftSize, fftSize);
+    window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    // Hann coherent gain is 0.5, so a full-scale sine reads 0 dBFS
+    juce::FloatVectorOperations::multiply(fftData.data(), 4.0f / (float) fftSize, fftSize / 2);
+
+    // peak of each display bin's FFT range; low bins narrower than one FFT bin reuse it
+    std::array<float, numBins> frame;
+
+    for (int b = 0; b < numBins; ++b)
+    {
+        const int lo = binEdges[(size_t) b];
+        const int hi = juce::jmax(lo + 1, binEdges[(size_t) b + 1]);
+        const auto peak = juce::FloatVectorOperations::findMaximum(fftData.data() + lo, juce::jmin(hi, fftSize / 2) - lo);
+
+        frame[(size_t) b] = juce::Decibels::gainToDecibels(peak, floorDb);
+    }
+
+    // one-pole smoothing across frames
+    juce::FloatVectorOperations::multiply(c.smoothed.data(), smoothing, numBins);
+    juce::FloatVectorOperations::addWithMultiply(c.smoothed.data(), frame.data(), 1.0f - smoothing, numBins);
+
+    out = c.smoothed;
+}
@@ -0,0 +1,117 @@
+//
+//  SpectrumAnalyzer.hpp
+//  StringSauce
+//
+//  Pre/post spectra for the editor. The audio thread only copies a
+//  mono sum into lock-free FIFOs, and only while a view is showing;
+//  windowing, FFTs and the log-frequency reduction run on a
+//  background thread at a capped frame rate.
+
+#ifndef SpectrumAnalyzer_hpp
+#define SpectrumAnalyzer_hpp
+#pragma once
+
+#include <JuceHeader.h>
+#include "Telemetry.hpp"
+
+class SpectrumAnalyzer : private juce::Thread
+{
+public:
+    static constexpr int fftOrder    = 11;
+    static constexpr int fftSize     = 1 << fftOrder;
+    static constexpr int numBins     = 128;
+    static constexpr int frameRateHz = 30;
+
+    static constexpr float minFrequency = 20.0f;
+    static constexpr float maxFrequency = 20000.0f;
+    static constexpr float floorDb      = -100.0f;
+
+    struct Frame
+    {
+        // dBFS per log-spaced bin from minFrequency to maxFrequency
+        std::array<float, numBins> pre {}, post {};
+        double sampleRate = 44100.0;
+    };
+
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer() override;
+
+    void prepare(double sampleRate);
+
+    // message thread; the thread and the audio-side copies only run while enabled
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // audio thread
+    template <typename SampleType>
+    void pushPre(const juce::AudioBuffer<SampleType>& buffer, int numChannels)  { push(pre, buffer, numChannels); }
+
+    template <typename SampleType>
+    void pushPost(const juce::AudioBuffer<SampleType>& buffer, int numChannels) { push(post, buffer, numChannels); }
+
+    // message thread; false when no new frame has been produced
+    bool getLatestFrame(Frame& dest);
+
+    // centre frequency of a display bin
+    static float getBinFrequency(int bin) noexcept;
+
+private:
+    struct Channel
+    {
+        juce::AbstractFifo fifo { fftSize * 4 };
+        std::vector<float> ring = std::vector<float>((size_t) fftSize * 4, 0.0f);
+
+        // background thread only
+        std::vector<float> history = std::vector<float>((size_t) fftSize, 0.0f);
+        std::array<float, numBins> smoothed {};
+    };
+
+    template <typename SampleType>
+    void push(Channel& c, const juce::AudioBuffer<SampleType>& buffer, int numChannels)
+    {
+        if (! enabled.load(std::memory_order_relaxed)) return;
+
+        const int numCh = juce::jmin(numChannels, buffer.getNumChannels());
+        const int numSm = buffer.getNumSamples();
+        if (numCh <= 0 || numSm <= 0) return;
+
+        // a full FIFO drops the newest samples; the view only needs the latest window
+        int start1, size1, start2, size2;
+        c.fifo.prepareToWrite(numSm, start1, size1, start2, size2);
+
+        const float scale = 1.0f / (float) numCh;
+
+        auto mix = [&](int dest, int src, int count)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                float s = 0.0f;
+                for (int ch = 0; ch < numCh; ++ch)
+                    s += (float) buffer.getReadPointer(ch)[src + i];
+                c.ring[(size_t) (dest + i)] = s * scale;
+            }
+        };
+
+        mix(start1, 0, size1);
+        mix(start2, size1, size2);
+        c.fifo.finishedWrite(size1 + size2);
+    }
+
+    void run() override;
+    void analyse(Channel& c, std::array<float, numBins>& out);
+
+    Channel pre, post;
+    std::atomic<bool> enabled { false };
+    std::atomic<double> sampleRate { 44100.0 };
+
+    // background thread only
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann };
+    std::vector<float> fftData = std::vector<float>((size_t) fftSize * 2, 0.0f);
+    std::array<int, numBins + 1> binEdges {};
+    double edgesRate = 0.0;
+
+    TripleBuffer<Frame> frames;
+};
+
+#endif
@@ -0,0 +1,94 @@
+//
+//  StageProfiler.cpp
+//  StringSauce
+//
+//  Implementation of the per-stage profiler
+
+#include "StageProfiler.hpp"
+
+#if STRINGSAUCE_PROFILING
+
+StageProfiler::StageProfiler()
+{
+    for (auto& ring : history)
+        for (auto& t : ring)
+            t.store(0);
+
+    for (auto& t : budget)
+        t.store(0);
+}
+
+void StageProfiler::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    pending.fill(0);
+}
+
+void StageProfiler::endBlock(int numSamples) noexcept
+{
+    const int n     = written.load(std::memory_order_relaxed);
+    const auto slot = (size_t) (n & (historySize - 1));
+
+    for (size_t s = 0; s < (size_t) numStages; ++s)
+    {
+        history[s][slot].store(pending[s], std::memory_order_relaxed);
+        pending[s] = 0;
+    }
+
+    const double blockSeconds = (double) numSamples / sampleRate;
+    budget[slot].store((juce::int64) (blockSeconds * (double) juce::Time::getHighResolutionTicksPerSecond()),
+                       std::memory_order_relaxed);
+
+    written.store(n + 1, std::memory_order_release);
+}
+
+StageProfiler::Summary StageProfiler::getSummary(Stage stage) const noexcept
+{
+    Summary summary;
+
+    const int n     = written.load(std::memory_order_acquire);
+    const int count = juce::jmin(n, historySize);
+    if (count == 0) return summary;
+
+    const auto& ring = history[(size_t) stage];
+
+    juce::int64 sum = 0, maxTicks = 0, budgetSum = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const auto slot = (size_t) ((n - 1 - i) & (historySize - 1));
+        const auto t    = ring[slot].load(std::memory_order_relaxed);
+
+        sum       += t;
+        maxTicks   = juce::jmax(maxTicks, t);
+        budgetSum += budget[slot].load(std::memory_order_relaxed);
+    }
+
+    const double usPerTick = 1.0e6 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    const auto latest      = ring[(size_t) ((n - 1) & (historySize - 1))].load(std::memory_order_relaxed);
+
+    summary.currentUs     = (double) latest * usPerTick;
+    summary.averageUs     = (double) sum * usPerTick / (double) count;
+    summary.maxUs         = (double) maxTicks * usPerTick;
+    summary.budgetPercent = budgetSum > 0 ? 100.0 * (double) sum / (double) budgetSum : 0.0;
+
+    return summary;
+}
+
+const char* StageProfiler::getStageName(Stage stage) noexcept
+{
+    switch (stage)
+    {
+        case eq:          return "EQ";
+        case dynamics:    return "Dynamics";
+        case saturation:  return "Saturation";
+        case spatial:     return "Spatial";
+        case autoGain:    return "AutoGain";
+        case toneEngine:  return "ToneEngine";
+        case numStages:   break;
+    }
+
+    return "";
+}
+
+#endif
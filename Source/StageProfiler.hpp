@@ -0,0 +1,91 @@
+//
+//  StageProfiler.hpp
+//  StringSauce
+//
+//  Per-stage block timings for the Debug window. Each stage's time
+//  is summed over a block on the audio thread, then pushed into a
+//  lock-free ring the UI reads from. Compiles out unless
+//  STRINGSAUCE_PROFILING is set; it defaults to on in debug builds.
+
+#ifndef StageProfiler_hpp
+#define StageProfiler_hpp
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef STRINGSAUCE_PROFILING
+ #if JUCE_DEBUG
+  #define STRINGSAUCE_PROFILING 1
+ #else
+  #define STRINGSAUCE_PROFILING 0
+ #endif
+#endif
+
+#if STRINGSAUCE_PROFILING
+
+class StageProfiler
+{
+public:
+    enum Stage { eq, dynamics, saturation, spatial, autoGain, toneEngine, numStages };
+
+    struct Summary
+    {
+        double currentUs     = 0.0;
+        double averageUs     = 0.0;
+        double maxUs         = 0.0;
+        double budgetPercent = 0.0;   // average share of the block's real-time duration
+    };
+
+    StageProfiler();
+
+    void prepare(double sampleRate);
+
+    // audio thread: accumulate into the open block, then close it
+    void add(Stage stage, juce::int64 ticks) noexcept { pending[(size_t) stage] += ticks; }
+    void endBlock(int numSamples) noexcept;
+
+    // any thread; averages and maxima cover the last historySize blocks
+    Summary getSummary(Stage stage) const noexcept;
+
+    static const char* getStageName(Stage stage) noexcept;
+
+    static constexpr int historySize = 128;
+
+    // times its scope into a stage; a null profiler is ignored
+    struct ScopedTimer
+    {
+        ScopedTimer(StageProfiler* p, Stage s) noexcept
+            : profiler(p), stage(s), start(p != nullptr ? juce::Time::getHighResolutionTicks() : 0) {}
+
+        ~ScopedTimer()
+        {
+            if (profiler != nullptr)
+                profiler->add(stage, juce::Time::getHighResolutionTicks() - start);
+        }
+
+        StageProfiler* profiler;
+        Stage stage;
+        juce::int64 start;
+    };
+
+private:
+    using Ring = std::array<std::atomic<juce::int64>, (size_t) historySize>;
+
+    std::array<Ring, numStages> history;
+    Ring budget;
+    std::atomic<int> written { 0 };
+
+    std::array<juce::int64, numStages> pending {};
+    double sampleRate = 44100.0;
+};
+
+ #define STRINGSAUCE_PROFILE_STAGE(profiler, stage) \
+    StageProfiler::ScopedTimer JUCE_JOIN_MACRO(stageTimer_, __LINE__) (profiler, StageProfiler::stage)
+
+#else
+
+ #define STRINGSAUCE_PROFILE_STAGE(profiler, stage)
+
+#endif
+
+#endif
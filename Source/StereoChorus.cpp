@@ -0,0 +1,151 @@
+//
+//  StereoChorus.cpp
+//  StringSauce
+//
+//  Implementation of the stereo chorus
+//
+//  The LFO only runs at control rate; per-sample delay times are
+//  linear ramps between control points, and read positions are
+//  built with FloatVectorOperations before the interpolated gather.
+
+#include "StereoChorus.hpp"
+
+StereoChorus::StereoChorus() {}
+
+void StereoChorus::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    sampleRate = spec.sampleRate > 0.0 ? spec.sampleRate : 44100.0;
+    const size_t numCh  = juce::jmax((size_t) 1, (size_t) spec.numChannels);
+    const int maxBlock  = juce::jmax(1, (int) spec.maximumBlockSize);
+
+    // longest tap plus one block written ahead of it, and the interpolation neighbour
+    const int maxDelay = (int) std::ceil((centreDelayMs + modulationMs) * 0.001 * sampleRate) + 2;
+    const int size     = juce::nextPowerOfTwo(maxDelay + maxBlock);
+    mask = size - 1;
+
+    lines.assign(numCh, std::vector<float>((size_t) size, 0.0f));
+    delayTimes.assign(numCh, std::vector<float>((size_t) maxBlock, 0.0f));
+    readPos.assign((size_t) maxBlock + 1, 0.0f);
+
+    ramp.resize((size_t) maxBlock + 1);
+    for (size_t i = 0; i < ramp.size(); ++i)
+        ramp[i] = (float) i;
+
+    currentDelay.assign(numCh, 0.0f);
+    delayStep.assign(numCh, 0.0f);
+
+    setRate(rate);
+    reset();
+}
+
+void StereoChorus::reset()
+{
+    for (auto& line : lines) std::fill(line.begin(), line.end(), 0.0f);
+
+    writePos     = 0;
+    phase        = 0.0;
+    untilControl = 0;
+
+    for (size_t ch = 0; ch < currentDelay.size(); ++ch)
+        currentDelay[ch] = delayAt(phase + (double) ch * juce::MathConstants<double>::halfPi);
+
+    std::fill(delayStep.begin(), delayStep.end(), 0.0f);
+}
+
+void StereoChorus::setRate(float hz)
+{
+    rate     = hz;
+    phaseInc = juce::MathConstants<double>::twoPi * (double) rate / sampleRate;
+}
+
+void StereoChorus::setDepth(float newDepth)
+{
+    depth = newDepth;
+}
+
+float StereoChorus::delayAt(double phaseToUse) const noexcept
+{
+    const float ms = juce::jmax(minimumDelayMs, centreDelayMs + modulationMs * depth * (float) std::sin(phaseToUse));
+    return ms * 0.001f * (float) sampleRate;
+}
+
+void StereoChorus::fillDelayTimes(int numSamples, size_t numCh)
+{
+    int done = 0;
+
+    while (done < numSamples)
+    {
+        if (untilControl == 0)
+        {
+            // aim at the LFO value one interval ahead; channels sit 90 degrees apart
+            phase += phaseInc * controlInterval;
+            if (phase >= juce::MathConstants<double>::twoPi)
+                phase -= juce::MathConstants<double>::twoPi;
+
+            for (size_t ch = 0; ch < numCh; ++ch)
+            {
+                const float target = delayAt(phase + (double) ch * juce::MathConstants<double>::halfPi);
+                delayStep[ch] = (target - currentDelay[ch]) / (float) controlInterval;
+            }
+
+            untilControl = controlInterval;
+        }
+
+        const int seg = juce::jmin(numSamples - done, untilControl);
+
+        for (size_t ch = 0; ch < numCh; ++ch)
+        {
+            auto* dst = delayTimes[ch].data() + done;
+
+            // current + step * (1 .. seg)
+            juce::FloatVectorOperations::copyWithMultiply(dst, ramp.data() + 1, delayStep[ch], seg);
+            juce::FloatVectorOperations::add(dst, currentDelay[ch], seg);
+
+            currentDelay[ch] += delayStep[ch] * (float) seg;
+        }
+
+        untilControl -= seg;
+        done         += seg;
+    }
+}
+
+void StereoChorus::process(juce::dsp::AudioBlock<float>& block)
+{
+    if (lines.empty()) return;
+
+    const size_t numCh = juce::jmin(block.getNumChannels(), lines.size());
+    const int numSm    = juce::jmin((int) block.getNumSamples(), (int) readPos.size() - 1);
+    const int size     = mask + 1;
+
+    fillDelayTimes(numSm, numCh);
+
+    // the block is written first, so taps down to one sample can read it
+    const int first = juce::jmin(numSm, size - writePos);
+
+    for (size_t ch = 0; ch < numCh; ++ch)
+    {
+        auto* data = block.getChannelPointer(ch);
+        auto* line = lines[ch].data();
+
+        juce::FloatVectorOperations::copy(line + writePos, data, first);
+        if (numSm > first)
+            juce::FloatVectorOperations::copy(line, data + first, numSm - first);
+
+        // readPos[i] = writePos + size + i - delay[i], always positive
+        auto* pos = readPos.data();
+        juce::FloatVectorOperations::subtract(pos, ramp.data(), delayTimes[ch].data(), numSm);
+        juce::FloatVectorOperations::add(pos, (float) (writePos + size), numSm);
+
+        for (int i = 0; i < numSm; ++i)
+        {
+            const int idx    = (int) pos[i];
+            const float frac = pos[i] - (float) idx;
+            const float a    = line[idx & mask];
+            const float b    = line[(idx + 1) & mask];
+
+            data[i] = a + frac * (b - a);
+        }
+    }
+
+    writePos = (writePos + numSm) & mask;
+}
@@ -0,0 +1,65 @@
+//
+//  StereoChorus.hpp
+//  StringSauce
+//
+//  Defines the chorus used by the Spatial module: a modulated
+//  delay with quadrature LFOs that outputs the wet signal only
+
+#ifndef StereoChorus_hpp
+#define StereoChorus_hpp
+#pragma once
+
+#include <JuceHeader.h>
+
+class StereoChorus
+{
+public:
+    StereoChorus();
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    void setRate (float hz);
+    void setDepth(float newDepth);   // [0..1]
+
+    // replaces block with the modulated signal; blending is left to the caller
+    void process(juce::dsp::AudioBlock<float>& block);
+
+    size_t getMemoryUsageBytes() const noexcept
+    {
+        size_t floats = ramp.size() + readPos.size();
+        for (auto& line : lines)      floats += line.size();
+        for (auto& t : delayTimes)    floats += t.size();
+        return floats * sizeof(float);
+    }
+
+    // same modulation range as juce::dsp::Chorus: centre +- 10 ms * depth
+    static constexpr float centreDelayMs   = 7.0f;
+    static constexpr float modulationMs    = 10.0f;
+    static constexpr float minimumDelayMs  = 1.0f;
+
+    // LFO is evaluated every this many samples and ramped in between
+    static constexpr int controlInterval   = 32;
+
+private:
+    void fillDelayTimes(int numSamples, size_t numCh);
+    float delayAt(double phaseToUse) const noexcept;
+
+    std::vector<std::vector<float>> lines;       // per channel, in samples
+    std::vector<std::vector<float>> delayTimes;  // per channel, per sample
+    std::vector<float> readPos;
+    std::vector<float> ramp;                     // 0, 1, 2, ...
+
+    std::vector<float> currentDelay, delayStep;
+
+    double sampleRate    = 44100.0;
+    double phase         = 0.0;
+    double phaseInc      = 0.0;
+    float rate           = 0.5f;
+    float depth          = 0.3f;
+    int mask             = 0;
+    int writePos         = 0;
+    int untilControl     = 0;
+};
+
+#endif
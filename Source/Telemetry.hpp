@@ -0,0 +1,65 @@
+//
+//  Telemetry.hpp
+//  StringSauce
+//
+//  Audio thread to editor snapshots. The audio thread fills and
+//  publishes one snapshot per block through a triple buffer; the
+//  message thread picks up the newest one. Neither side waits.
+
+#ifndef Telemetry_hpp
+#define Telemetry_hpp
+#pragma once
+
+#include <JuceHeader.h>
+#include "ToneEngine.hpp"
+#include "DynamicsProcessor.hpp"
+
+struct TelemetrySnapshot
+{
+    ToneEngine::EngineParameters params;
+
+    // per channel, linear; a mono input only fills the first entry
+    std::array<float, 2> inputPeak  {}, inputRms  {};
+    std::array<float, 2> outputPeak {}, outputRms {};
+
+    DynamicsProcessorBase::Meters dynamics;
+
+    juce::uint64 blockCount = 0;
+};
+
+// wait-free single producer / single consumer hand-off of the latest value
+template <typename T>
+class TripleBuffer
+{
+public:
+    // producer: fill this, then publish()
+    T& getWriteSlot() noexcept { return slots[(size_t) back]; }
+
+    void publish() noexcept
+    {
+        back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // consumer: swaps in the newest published value, if any; false when nothing new
+    bool update() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& getReadSlot() const noexcept { return slots[(size_t) front]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit  = 4;
+
+    std::array<T, 3> slots {};
+    std::atomic<int> middle { 1 };
+    int back  = 0;   // producer only
+    int front = 2;   // consumer only
+};
+
+#endif
@@ -143,10 +143,29 @@ void ToneEngine::initSmoothing(double sampleRate)
         s.reset(sampleRate, smoothingTime);
 }
 
+void ToneEngine::setTempoSync(bool enabled, double bpm)
+{
+    tempoSyncEnabled = enabled;
+    hostBpm          = bpm;
+}
+
 void ToneEngine::updateParameters(float character, float thump, float body,
                                   float shimmer, float spank, float space,
                                   Mode mode)
 {
+    const std::array<float, 6> macros { character, thump, body, shimmer, spank, space };
+
+    if (hasMapped && macros == lastMacros && mode == currentMode
+        && tempoSyncEnabled == lastSyncEnabled
+        && (! tempoSyncEnabled || hostBpm == lastBpm))
+        return;
+
+    hasMapped       = true;
+    lastMacros      = macros;
+    lastSyncEnabled = tempoSyncEnabled;
+    lastBpm         = hostBpm;
+    ++generation;
+
     currentMode = mode;
 
     auto mappedEQ                           = ParameterMapper::mapEQ(character, thump, body, shimmer, mode);
@@ -201,6 +220,23 @@ void ToneEngine::updateParameters(float character, float thump, float body,
     currentParams.spatial.chorusDepth       = mappedSpatial.chorusDepth;
     currentParams.spatial.chorusMix         = mappedSpatial.chorusMix;
 
+    if (tempoSyncEnabled && hostBpm > 0.0)
+    {
+        if (hostBpm != syncedBpm
+            || mappedSpatial.delayTimeLeft  != syncedFromLeft
+            || mappedSpatial.delayTimeRight != syncedFromRight)
+        {
+            syncedBpm       = hostBpm;
+            syncedFromLeft  = mappedSpatial.delayTimeLeft;
+            syncedFromRight = mappedSpatial.delayTimeRight;
+            syncedLeft      = ParameterMapper::quantizeDelayToTempo(syncedFromLeft,  hostBpm);
+            syncedRight     = ParameterMapper::quantizeDelayToTempo(syncedFromRight, hostBpm);
+        }
+
+        currentParams.spatial.delayTimeLeft  = syncedLeft;
+        currentParams.spatial.delayTimeRight = syncedRight;
+    }
+
     currentParams.effects.shimmerPitch      = shimmer * 12.0f;
     currentParams.effects.shimmerMix        = shimmer * 0.4f;
     
@@ -43,13 +43,34 @@ public:
     void prepare(const juce::dsp::ProcessSpec& spec);
     void updateParameters(float character, float thump, float body, float shimmer, float spank, float space, Mode mode);
 
+    // host tempo for synced delay times, cached by the caller once per block
+    void setTempoSync(bool enabled, double bpm);
+
     const EngineParameters& getCurrentParameters() const { return currentParams; }
 
+    // bumped whenever updateParameters() produces new values
+    juce::uint32 getParameterGeneration() const { return generation; }
+
 private:
     void initSmoothing(double sampleRate);
 
     EngineParameters currentParams;
     Mode currentMode;
+
+    // inputs of the last mapping; identical calls return early
+    std::array<float, 6> lastMacros {};
+    bool lastSyncEnabled = false;
+    double lastBpm       = 0.0;
+    bool hasMapped       = false;
+    juce::uint32 generation = 0;
+
+    bool tempoSyncEnabled = false;
+    double hostBpm        = 0.0;
+
+    // last quantisation, reused while tempo and mapped times are unchanged
+    double syncedBpm      = 0.0;
+    float syncedFromLeft  = -1.0f, syncedFromRight = -1.0f;
+    float syncedLeft      = 0.0f,  syncedRight     = 0.0f;
     std::array<juce::LinearSmoothedValue<float>, 16> smoothedParams;
 };
 
@@ -0,0 +1,241 @@
+//
+//  WetResampler.cpp
+//  StringSauce
+//
+//  Implementation of the halfband resampler cascade
+//
+//  Each stage is a Blackman-windowed halfband FIR run in polyphase
+//  form: the decimator only evaluates every second output and the
+//  interpolator splits into its centre tap and its symmetric pairs.
+
+#include "WetResampler.hpp"
+
+WetResampler::WetResampler()
+{
+    // odd offsets of the ideal halfband, windowed and normalised to unity DC gain
+    const int numTaps = 4 * halfTaps - 1;
+    float sum = 0.0f;
+
+    for (int k = 0; k < halfTaps; ++k)
+    {
+        const int offset = 2 * k + 1;
+        const double n   = (double) (centre + offset) / (double) (numTaps - 1);
+        const double w   = 0.42 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * n)
+                                + 0.08 * std::cos(2.0 * juce::MathConstants<double>::twoPi * n);
+        const double s   = (k % 2 == 0 ? 1.0 : -1.0) / (juce::MathConstants<double>::pi * offset);
+
+        coeffs[k] = (float) (w * s);
+        sum      += coeffs[k];
+    }
+
+    for (auto& c : coeffs)
+        c *= 0.25f / sum;
+}
+
+void WetResampler::prepare(int newNumChannels, int maximumBlockSize, int newNumStages)
+{
+    numChannels = juce::jlimit(1, maxChannels, newNumChannels);
+    numStages   = juce::jmax(0, newNumStages);
+    maxBlock    = juce::jmax(1, maximumBlockSize);
+
+    stages.resize((size_t) numStages);
+
+    if (numStages == 0)
+    {
+        fifo.clear();
+        fifoMask = 0;
+        reset();
+        return;
+    }
+
+    for (int s = 0; s < numStages; ++s)
+    {
+        auto& st = stages[(size_t) s];
+        st.decim .assign((size_t) numChannels, std::vector<float>(2 * decimHistory, 0.0f));
+        st.interp.assign((size_t) numChannels, std::vector<float>(2 * interpHistory, 0.0f));
+
+        // down holds this stage's decimated output, up its interpolated output
+        st.down.setSize(numChannels, (maxBlock >> (s + 1)) + 2);
+        st.up  .setSize(numChannels, (maxBlock >> s) + 4);
+    }
+
+    // the round trip can come up short by factor - 1 samples per block
+    const int fifoSize = juce::nextPowerOfTwo(maxBlock + 2 * getFactor() + 4);
+    fifoMask = fifoSize - 1;
+    fifo.assign((size_t) numChannels, std::vector<float>((size_t) fifoSize, 0.0f));
+
+    reset();
+}
+
+void WetResampler::reset()
+{
+    for (auto& st : stages)
+    {
+        for (auto& h : st.decim)  std::fill(h.begin(), h.end(), 0.0f);
+        for (auto& h : st.interp) std::fill(h.begin(), h.end(), 0.0f);
+        st.decimPos  = 0;
+        st.interpPos = 0;
+        st.odd       = false;
+    }
+
+    for (auto& f : fifo) std::fill(f.begin(), f.end(), 0.0f);
+
+    // prime with the largest possible shortfall so a block never runs dry
+    fifoRead  = 0;
+    fifoWrite = getFactor() - 1;
+}
+
+int WetResampler::decimate(Stage& st, const float* const* src, float* const* dst, int numIn)
+{
+    int pos = st.decimPos, numOut = 0;
+    bool odd = st.odd;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* hist  = st.decim[(size_t) ch].data();
+        const auto* in = src[ch];
+        auto* out      = dst[ch];
+
+        pos = st.decimPos; odd = st.odd; numOut = 0;
+
+        for (int i = 0; i < numIn; ++i)
+        {
+            pos = pos + 1 == decimHistory ? 0 : pos + 1;
+            hist[pos] = hist[pos + decimHistory] = in[i];
+
+            odd = ! odd;
+            if (odd) continue;
+
+            // every second input: centre tap plus the symmetric odd pairs
+            const float* x = hist + pos + decimHistory - centre;
+            float y = 0.5f * x[0];
+
+            for (int k = 0; k < halfTaps; ++k)
+                y += coeffs[k] * (x[2 * k + 1] + x[-(2 * k + 1)]);
+
+            out[numOut++] = y;
+        }
+    }
+
+    st.decimPos = pos;
+    st.odd      = odd;
+    return numOut;
+}
+
+void WetResampler::interpolate(Stage& st, const float* const* src, float* const* dst, int numIn)
+{
+    int pos = st.interpPos;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* hist     = st.interp[(size_t) ch].data();
+        const auto* in = src[ch];
+        auto* out      = dst[ch];
+
+        pos = st.interpPos;
+
+        for (int i = 0; i < numIn; ++i)
+        {
+            pos = pos + 1 == interpHistory ? 0 : pos + 1;
+            hist[pos] = hist[pos + interpHistory] = in[i];
+
+            // x[-d] is the input d samples back
+            const float* x = hist + pos + interpHistory;
+            float even = 0.0f;
+
+            for (int k = 0; k < halfTaps; ++k)
+                even += coeffs[k] * (x[-(centre - 2 * k - 1) / 2] + x[-(centre + 2 * k + 1) / 2]);
+
+            out[2 * i]     = 2.0f * even;
+            out[2 * i + 1] = x[-(centre - 1) / 2];
+        }
+    }
+
+    st.interpPos = pos;
+}
+
+int WetResampler::downsample(const juce::dsp::AudioBlock<float>& input, juce::AudioBuffer<float>& output)
+{
+    if (numStages == 0) return 0;
+
+    const float* src[maxChannels] {};
+    for (int ch = 0; ch < numChannels; ++ch)
+        src[ch] = input.getChannelPointer((size_t) juce::jmin(ch, (int) input.getNumChannels() - 1));
+
+    int n = (int) input.getNumSamples();
+
+    for (int s = 0; s < numStages; ++s)
+    {
+        auto& st = stages[(size_t) s];
+        auto& dest = s == numStages - 1 ? output : st.down;
+
+        n = decimate(st, src, dest.getArrayOfWritePointers(), n);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            src[ch] = dest.getReadPointer(ch);
+    }
+
+    return n;
+}
+
+void WetResampler::upsample(const juce::AudioBuffer<float>& input, int numLow, juce::dsp::AudioBlock<float>& output)
+{
+    if (numStages == 0) return;
+
+    const float* src[maxChannels] {};
+    for (int ch = 0; ch < numChannels; ++ch)
+        src[ch] = input.getReadPointer(ch);
+
+    int n = numLow;
+
+    for (int s = numStages - 1; s >= 0; --s)
+    {
+        auto& st = stages[(size_t) s];
+        interpolate(st, src, st.up.getArrayOfWritePointers(), n);
+        n *= 2;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            src[ch] = st.up.getReadPointer(ch);
+    }
+
+    // queue the full-rate result and hand out exactly one block of it
+    const int numOut = (int) output.getNumSamples();
+    const int size   = fifoMask + 1;
+    const size_t outCh = juce::jmin(output.getNumChannels(), (size_t) numChannels);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* f = fifo[(size_t) ch].data();
+
+        const int first = juce::jmin(n, size - fifoWrite);
+        juce::FloatVectorOperations::copy(f + fifoWrite, src[ch], first);
+        juce::FloatVectorOperations::copy(f, src[ch] + first, n - first);
+
+        if ((size_t) ch < outCh)
+        {
+            auto* out = output.getChannelPointer((size_t) ch);
+            const int firstOut = juce::jmin(numOut, size - fifoRead);
+            juce::FloatVectorOperations::copy(out, f + fifoRead, firstOut);
+            juce::FloatVectorOperations::copy(out + firstOut, f, numOut - firstOut);
+        }
+    }
+
+    fifoWrite = (fifoWrite + n)      & fifoMask;
+    fifoRead  = (fifoRead  + numOut) & fifoMask;
+}
+
+size_t WetResampler::getMemoryUsageBytes() const noexcept
+{
+    size_t floats = 0;
+
+    for (auto& st : stages)
+    {
+        floats += (size_t) numChannels * (2 * decimHistory + 2 * interpHistory);
+        floats += (size_t) (st.down.getNumChannels() * st.down.getNumSamples());
+        floats += (size_t) (st.up.getNumChannels()   * st.up.getNumSamples());
+    }
+
+    for (auto& f : fifo) floats += f.size();
+
+    return floats * sizeof(float);
+}
@@ -0,0 +1,78 @@
+//
+//  WetResampler.hpp
+//  StringSauce
+//
+//  Defines the halfband resampler cascade that moves the spatial
+//  wet paths down to a ~48 kHz internal rate and back up again
+
+#ifndef WetResampler_hpp
+#define WetResampler_hpp
+#pragma once
+
+#include <JuceHeader.h>
+
+class WetResampler
+{
+public:
+    WetResampler();
+
+    // factor is 2^numStages; 0 stages passes nothing through and should not be used
+    void prepare(int numChannels, int maximumBlockSize, int numStages);
+    void reset();
+
+    int getFactor() const noexcept { return 1 << numStages; }
+
+    // maximum low-rate samples a single downsample() can produce
+    int getMaximumLowBlockSize() const noexcept { return (maxBlock >> numStages) + 1; }
+
+    // full-rate samples an up(down(x)) round trip trails x by
+    int getLatencyInSamples() const noexcept { return (getFactor() - 1) * 2 * centre; }
+
+    // decimates the block into output and returns how many low-rate samples were written
+    int downsample(const juce::dsp::AudioBlock<float>& input, juce::AudioBuffer<float>& output);
+
+    // interpolates numLow samples of input and fills output with exactly its length,
+    // taking the remainder from the previous call
+    void upsample(const juce::AudioBuffer<float>& input, int numLow, juce::dsp::AudioBlock<float>& output);
+
+    size_t getMemoryUsageBytes() const noexcept;
+
+    // non-zero taps on each side of the centre; 4 * halfTaps - 1 taps in total
+    static constexpr int halfTaps = 12;
+
+    static constexpr int maxChannels = 8;
+
+private:
+    static constexpr int centre        = 2 * halfTaps - 1;
+    static constexpr int decimHistory  = 2 * centre + 1;
+    static constexpr int interpHistory = centre + 1;
+
+    struct Stage
+    {
+        // doubled rings, so the newest sample always has its whole history behind it
+        std::vector<std::vector<float>> decim, interp;
+        int decimPos  = 0;
+        int interpPos = 0;
+        bool odd      = false;
+
+        // output of this stage's decimator and input of its interpolator's caller
+        juce::AudioBuffer<float> down, up;
+    };
+
+    int decimate   (Stage& st, const float* const* src, float* const* dst, int numIn);
+    void interpolate(Stage& st, const float* const* src, float* const* dst, int numIn);
+
+    float coeffs[halfTaps] {};
+
+    std::vector<Stage> stages;
+    std::vector<std::vector<float>> fifo;
+
+    int numChannels = 0;
+    int numStages   = 0;
+    int maxBlock    = 0;
+    int fifoMask    = 0;
+    int fifoRead    = 0;
+    int fifoWrite   = 0;
+};
+
+#endif